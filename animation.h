@@ -0,0 +1,349 @@
+#ifndef UWDG_ANIMATION_H
+#define UWDG_ANIMATION_H
+
+#include "delegate.h"
+#include "valueWidget.h"
+#include "widget.h"
+
+// number of animations that can run at the same time
+#ifndef UWDG_ANIMATIONS
+#define UWDG_ANIMATIONS 8
+#endif
+
+namespace uwdg
+{
+
+/* Fixed-point tween engine.
+
+  Each animation interpolates from a start to an end state over a duration,
+  driven by tick(), which should be called once per frame before
+  Widget::drawWidgets(). Progress is computed from the frame time, so a late
+  or skipped frame makes animations jump ahead instead of slowing down.
+  Animations start at the first tick() after they were started and only
+  ever see the times passed to tick(), so any clock can drive them. All
+  property changes of a frame are applied in one tick and only damage what
+  they touch: a moved or resized widget damages the union of its old and new
+  bounds in its parent.
+
+  tick() can be given a time budget. When it runs out, the remaining
+  animations keep their state and are served first on the next tick, so a
+  slow target loses animation frames but not input handling time.
+
+  Animations refer to widgets by pointer. A widget cancels its animations
+  when it is destroyed, including the setter animations started with it.
+*/
+class Animator
+{
+public:
+  typedef int8_t handle_t;
+  typedef Delegate<void(int32_t)> IntSetter;
+  typedef Delegate<void(Color)> ColorSetter;
+
+  enum Easing
+  {
+    eLinear,
+    eEaseIn,
+    eEaseOut,
+    eEaseInOut
+  };
+
+  static Animator& instance()
+  {
+    static Animator a_;
+    return a_;
+  }
+
+  /*****************************************************************************
+  * Starting and stopping. Starting returns a handle, or -1 if all slots are
+  * taken. Durations are in milliseconds.
+  *****************************************************************************/
+  handle_t moveTo(Widget* w, const Point& to, delaytime_t ms, Easing e = eEaseInOut)
+  {
+    Tween* t = start(w, ePosition, ms, e);
+    if(t == nullptr)
+    {
+      return -1;
+    }
+    t->from[0] = w->position().x;
+    t->from[1] = w->position().y;
+    t->to[0] = to.x;
+    t->to[1] = to.y;
+    return t - tweens_;
+  }
+
+  handle_t resize(Widget* w, const Size& to, delaytime_t ms, Easing e = eEaseInOut)
+  {
+    Tween* t = start(w, eSize, ms, e);
+    if(t == nullptr)
+    {
+      return -1;
+    }
+    t->from[0] = w->width();
+    t->from[1] = w->height();
+    t->to[0] = to.w;
+    t->to[1] = to.h;
+    return t - tweens_;
+  }
+
+  handle_t setValue(ValueWidget* w, ValueWidget::Value to, delaytime_t ms,
+                    Easing e = eEaseInOut)
+  {
+    Tween* t = start(w, eValue, ms, e);
+    if(t == nullptr)
+    {
+      return -1;
+    }
+    t->from[0] = w->value();
+    t->to[0] = to;
+    return t - tweens_;
+  }
+
+  // any integer property; w (may be nullptr) is only used for cancel()
+  handle_t animate(const IntSetter& setter, int32_t from, int32_t to,
+                   delaytime_t ms, Easing e = eEaseInOut, Widget* w = nullptr)
+  {
+    Tween* t = start(w, eInt, ms, e);
+    if(t == nullptr)
+    {
+      return -1;
+    }
+    t->intSetter = setter;
+    t->from[0] = from;
+    t->to[0] = to;
+    return t - tweens_;
+  }
+
+  // blends between two colors, e.g. for a style color followed by redraw()
+  handle_t animateColor(const ColorSetter& setter, Color from, Color to,
+                        delaytime_t ms, Easing e = eEaseInOut, Widget* w = nullptr)
+  {
+    Tween* t = start(w, eColor, ms, e);
+    if(t == nullptr)
+    {
+      return -1;
+    }
+    t->colorSetter = setter;
+    t->from[0] = from;
+    t->to[0] = to;
+    return t - tweens_;
+  }
+
+  // stops an animation where it is
+  void cancel(handle_t h)
+  {
+    if((h >= 0) && (h < UWDG_ANIMATIONS))
+    {
+      tweens_[h].kind = eNone;
+    }
+  }
+
+  // stops all animations of w
+  void cancel(const Widget* w)
+  {
+    for(Tween& t : tweens_)
+    {
+      if(t.widget == w)
+      {
+        t.kind = eNone;
+      }
+    }
+  }
+
+  bool running(handle_t h) const
+  {
+    return (h >= 0) && (h < UWDG_ANIMATIONS) && (tweens_[h].kind != eNone);
+  }
+
+  bool running() const
+  {
+    for(const Tween& t : tweens_)
+    {
+      if(t.kind != eNone)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*****************************************************************************
+  * Frame clock
+  *****************************************************************************/
+  // budget: ticks this call may take, 0 for no limit
+  void tick(systemticks_t now = gfxSystemTicks(), systemticks_t budget = 0)
+  {
+    const systemticks_t begin = gfxSystemTicks();
+    // new animations start now, also those the budget leaves for later
+    for(Tween& t : tweens_)
+    {
+      if(t.waiting)
+      {
+        t.start = now;
+        t.waiting = false;
+      }
+    }
+    for(uint8_t n = 0; n < UWDG_ANIMATIONS; n++)
+    {
+      if((budget != 0) && (n != 0) && (gfxSystemTicks() - begin >= budget))
+      {
+        return; // continue with next_ on the next tick
+      }
+      Tween& t = tweens_[next_];
+      next_ = (next_ + 1) % UWDG_ANIMATIONS;
+      if(t.kind != eNone)
+      {
+        step(t, now);
+      }
+    }
+  }
+
+private:
+  enum Kind
+  {
+    eNone,
+    ePosition,
+    eSize,
+    eValue,
+    eInt,
+    eColor
+  };
+
+  struct Tween
+  {
+    uint8_t kind;
+    uint8_t easing;
+    bool waiting; // for its start time from the next tick()
+    Widget* widget;
+    systemticks_t start;
+    systemticks_t duration;
+    int32_t from[2];
+    int32_t to[2];
+    IntSetter intSetter;
+    ColorSetter colorSetter;
+  };
+
+  Animator() :
+    next_(0)
+  {
+    for(Tween& t : tweens_)
+    {
+      t.kind = eNone;
+      t.waiting = false;
+      t.widget = nullptr;
+    }
+  }
+
+  // takes over a running animation of the same kind on the same widget
+  Tween* start(Widget* w, Kind k, delaytime_t ms, Easing e)
+  {
+    Tween* slot = nullptr;
+    for(Tween& t : tweens_)
+    {
+      if((w != nullptr) && (t.widget == w) && (t.kind == k))
+      {
+        slot = &t;
+        break;
+      }
+      if((slot == nullptr) && (t.kind == eNone))
+      {
+        slot = &t;
+      }
+    }
+    if(slot != nullptr)
+    {
+      slot->kind = k;
+      slot->easing = e;
+      slot->widget = w;
+      slot->waiting = true;
+      slot->duration = gfxMillisecondsToTicks(ms);
+    }
+    return slot;
+  }
+
+  // eased progress 0..65536 (Q16)
+  static int32_t ease(uint8_t e, int32_t p)
+  {
+    switch(e)
+    {
+      case eEaseIn:
+        return (p * (int64_t)p) >> 16;
+      case eEaseOut:
+        return 65536 - (((65536 - p) * (int64_t)(65536 - p)) >> 16);
+      case eEaseInOut:
+      {
+        // smoothstep: 3p^2 - 2p^3
+        int64_t p2 = (p * (int64_t)p) >> 16;
+        int64_t p3 = (p2 * p) >> 16;
+        return (int32_t)(3 * p2 - 2 * p3);
+      }
+      default:
+        return p;
+    }
+  }
+
+  static int32_t lerp(int32_t a, int32_t b, int32_t q)
+  {
+    return a + (int32_t)(((int64_t)(b - a) * q) >> 16);
+  }
+
+  void step(Tween& t, systemticks_t now)
+  {
+    systemticks_t elapsed = now - t.start;
+    bool done = (static_cast<int32_t>(elapsed) < 0) ? false : (elapsed >= t.duration);
+    int32_t p = 65536;
+    if(!done)
+    {
+      p = (static_cast<int32_t>(elapsed) <= 0) ? 0 :
+          (int32_t)(((int64_t)elapsed << 16) / t.duration);
+    }
+    int32_t q = ease(t.easing, p);
+    switch(t.kind)
+    {
+      case ePosition:
+      {
+        Point to(lerp(t.from[0], t.to[0], q), lerp(t.from[1], t.to[1], q));
+        if((to.x != t.widget->position().x) || (to.y != t.widget->position().y))
+        {
+          t.widget->moveTo(to);
+        }
+        break;
+      }
+      case eSize:
+      {
+        Size to(lerp(t.from[0], t.to[0], q), lerp(t.from[1], t.to[1], q));
+        if((to.w != t.widget->width()) || (to.h != t.widget->height()))
+        {
+          Rectangle old = t.widget->geometry();
+          t.widget->setSize(to);
+          t.widget->damageInParent(old | t.widget->geometry());
+        }
+        break;
+      }
+      case eValue:
+        static_cast<ValueWidget*>(t.widget)->setValue(lerp(t.from[0], t.to[0], q));
+        break;
+      case eInt:
+        t.intSetter(lerp(t.from[0], t.to[0], q));
+        break;
+      case eColor:
+        // gdispBlendColor takes the foreground weight as alpha 0..255
+        t.colorSetter(gdispBlendColor((Color)t.to[0], (Color)t.from[0],
+                                      (uint8_t)(((int64_t)q * 255) >> 16)));
+        break;
+      default:
+        break;
+    }
+    if(done)
+    {
+      t.kind = eNone;
+      t.widget = nullptr;
+    }
+  }
+
+  Tween tweens_[UWDG_ANIMATIONS];
+  uint8_t next_;
+};
+
+} // namespace uwdg
+
+#endif // UWDG_ANIMATION_H
@@ -0,0 +1,240 @@
+#ifndef UWDG_ASYNCSCREEN_H
+#define UWDG_ASYNCSCREEN_H
+
+#include "widget.h"
+
+#if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+
+#include <coroutine>
+#include <exception>
+
+namespace uwdg
+{
+
+/* Screens built by a C++20 coroutine, a slice at a time.
+
+  The construction code is written sequentially and returns the new root
+  with co_return. Wherever it may be interrupted (after creating a batch of
+  widgets, while waiting for data) it does co_await nextSlice():
+
+    ScreenTask buildSettings(Storage& s)
+    {
+      Widget* root = new Widget;
+      for(uint8_t i = 0; i < s.count(); i++)
+      {
+        new Label(s.name(i), root);
+        co_await nextSlice();
+      }
+      while(!s.loaded())
+      {
+        co_await nextSlice();
+      }
+      co_return root;
+    }
+
+  AsyncScreen puts the placeholder root (if any) on top right away and
+  resumes the coroutine from step(), once per frame, for as long as its
+  budget allows. Roots created by the coroutine are kept below the current
+  ones. The focus doesn't move while the coroutine runs: creating a root
+  doesn't drop it and giveFocus() does nothing, so the current screen keeps
+  it without any focus callbacks and gets the input as before. When the
+  coroutine returns, the placeholder is taken out of the root list and
+  replaced by the new root, which gets the focus. The placeholder can be
+  deleted or reused afterwards.
+
+  Coroutine frames are allocated with operator new.
+*/
+class ScreenTask
+{
+public:
+  struct promise_type
+  {
+    Widget* root = nullptr;
+
+    ScreenTask get_return_object()
+    {
+      return ScreenTask(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept
+    {
+      return {};
+    }
+
+    std::suspend_always final_suspend() noexcept
+    {
+      return {};
+    }
+
+    void return_value(Widget* w)
+    {
+      root = w;
+    }
+
+    void unhandled_exception()
+    {
+      std::terminate();
+    }
+  };
+
+  ScreenTask(ScreenTask&& other) noexcept :
+    handle_(other.handle_)
+  {
+    other.handle_ = nullptr;
+  }
+
+  ~ScreenTask()
+  {
+    if(handle_)
+    {
+      handle_.destroy();
+    }
+  }
+
+  bool done() const
+  {
+    return !handle_ || handle_.done();
+  }
+
+  void resume()
+  {
+    if(!done())
+    {
+      handle_.resume();
+    }
+  }
+
+  // the returned root, nullptr while running
+  Widget* root() const
+  {
+    return (handle_ && handle_.done()) ? handle_.promise().root : nullptr;
+  }
+
+private:
+  explicit ScreenTask(std::coroutine_handle<promise_type> h) :
+    handle_(h)
+  {
+  }
+
+  ScreenTask(const ScreenTask&) = delete;
+  ScreenTask& operator=(const ScreenTask&) = delete;
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+// co_await nextSlice(): lets step() return to the frame loop if its time is up
+struct NextSlice
+{
+  bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void await_suspend(std::coroutine_handle<>) const noexcept
+  {
+  }
+
+  void await_resume() const noexcept
+  {
+  }
+};
+
+inline NextSlice nextSlice()
+{
+  return NextSlice();
+}
+
+class AsyncScreen
+{
+public:
+  // placeholder may be nullptr, otherwise it's shown until the screen is built
+  AsyncScreen(ScreenTask&& task, Widget* placeholder = nullptr) :
+    task_(static_cast<ScreenTask&&>(task)),
+    placeholder_(placeholder),
+    raised_(false)
+  {
+    if(placeholder_ != nullptr)
+    {
+      Widget::raiseRoot(placeholder_);
+    }
+  }
+
+  /* Runs the construction for at least one slice and until budget ticks have
+    passed (0: one slice only). Call once per frame before
+    Widget::drawWidgets(). Returns true when the new root is up.
+  */
+  bool step(systemticks_t budget = 0)
+  {
+    const systemticks_t begin = gfxSystemTicks();
+    while(!task_.done())
+    {
+      resumeSlice();
+      if((budget == 0) || (gfxSystemTicks() - begin >= budget))
+      {
+        break;
+      }
+    }
+    if(task_.done() && !raised_ && (task_.root() != nullptr))
+    {
+      if(placeholder_ != nullptr)
+      {
+        Widget::removeRoot(placeholder_);
+      }
+      Widget::raiseRoot(task_.root());
+      raised_ = true;
+    }
+    return raised_;
+  }
+
+  bool done() const
+  {
+    return raised_;
+  }
+
+  Widget* placeholder() const
+  {
+    return placeholder_;
+  }
+
+  // the finished root, nullptr while under construction
+  Widget* root() const
+  {
+    return raised_ ? task_.root() : nullptr;
+  }
+
+private:
+  // resumes once, keeping new roots below the current top root
+  void resumeSlice()
+  {
+    Widget* const top = Widget::rootWidgets_;
+    {
+      Widget::FocusLock lock;
+      task_.resume();
+    }
+    // roots are added in front of the list
+    uint16_t added = 0;
+    Widget* w = Widget::rootWidgets_;
+    while((w != nullptr) && (w != top))
+    {
+      added++;
+      w = w->next_;
+    }
+    if(w == top)
+    {
+      while(added-- != 0)
+      {
+        Widget::lowerRoot(Widget::rootWidgets_);
+      }
+    }
+  }
+
+  ScreenTask task_;
+  Widget* placeholder_;
+  bool raised_;
+};
+
+} // namespace uwdg
+
+#endif // __cpp_impl_coroutine
+
+#endif // UWDG_ASYNCSCREEN_H
@@ -0,0 +1,326 @@
+#ifndef UWDG_BITMAPCACHE_H
+#define UWDG_BITMAPCACHE_H
+
+#include <gfx.h>
+#include <stddef.h>
+
+#include "lock.h"
+
+// number of decoded images the cache can hold
+#ifndef UWDG_BITMAPS
+#define UWDG_BITMAPS 8
+#endif
+
+// default limit for the pixel memory of all decoded images
+#ifndef UWDG_BITMAP_BUDGET
+#define UWDG_BITMAP_BUDGET 32768
+#endif
+
+namespace uwdg
+{
+
+#if GDISP_NEED_IMAGE && GDISP_NEED_PIXMAP
+/* Shared cache of decoded images.
+
+  Images are identified by their encoded data in memory (anything
+  gdispImageOpenMemory() understands) and decoded into a pixmap in the
+  display's native pixel format on first use, so drawing a cached image is a
+  single gdispGBlitArea(). When the pixels of all decoded images would exceed
+  the byte budget, the least recently used ones are dropped. An image larger
+  than the whole budget is not cached and can't be drawn.
+
+  Screens can decode their images right after loading with predecode(), so
+  the first frame doesn't pay for it.
+
+  Drawing code passes a pin mask (see CachePins) to get(): the bitmap is then
+  pinned until the mask is released, i.e. until the frame that draws or
+  records it is done, and is neither evicted nor freed before. evict() and
+  clear() free pinned bitmaps when their last pin is released. Without pins,
+  a Bitmap stays valid until the next get(), predecode() or eviction, from
+  any thread. The
+  cache is locked, so passes for different displays can use it from
+  different threads.
+*/
+class BitmapCache
+{
+public:
+  struct Bitmap
+  {
+    const void* source;
+    GDisplay* pixmap;
+    const pixel_t* bits;
+    coord_t width;
+    coord_t height;
+    uint32_t lastUse;
+    uint8_t pins; // masks holding this bitmap
+
+    size_t bytes() const
+    {
+      return (size_t)width * height * sizeof(pixel_t);
+    }
+  };
+
+  struct Stats
+  {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t failures;     // couldn't decode or too large
+    size_t bytes;          // currently decoded
+    size_t peakBytes;
+    systemticks_t decodeTicks; // spent decoding
+  };
+
+  static BitmapCache& instance()
+  {
+    static BitmapCache c_;
+    return c_;
+  }
+
+  size_t budget() const
+  {
+    return budget_;
+  }
+
+  // pinned bitmaps stay until they are released
+  void setBudget(size_t bytes)
+  {
+    Lock lock(mutex_);
+    budget_ = bytes;
+    while((stats_.bytes > budget_) && evictOldest())
+    {
+    }
+  }
+
+  /* Decodes source on a miss; nullptr if it can't be decoded or doesn't fit
+    next to the pinned bitmaps. If pins is given, the bitmap is added to it.
+  */
+  const Bitmap* get(const void* source, uint32_t* pins = nullptr)
+  {
+    Lock lock(mutex_);
+    Bitmap* b = find(source);
+    if(b != nullptr)
+    {
+      stats_.hits++;
+    }
+    else
+    {
+      stats_.misses++;
+      b = decode(source);
+    }
+    if(b != nullptr)
+    {
+      b->lastUse = ++useCount_;
+      const uint32_t bit = 1UL << (b - bitmaps_);
+      if((pins != nullptr) && !(*pins & bit))
+      {
+        *pins |= bit;
+        b->pins++;
+      }
+    }
+    return b;
+  }
+
+  // releases the bitmaps in pins and clears it
+  void unpin(uint32_t& pins)
+  {
+    Lock lock(mutex_);
+    for(uint8_t i = 0; (i < UWDG_BITMAPS) && (pins != 0); i++)
+    {
+      if(pins & (1UL << i))
+      {
+        pins &= ~(1UL << i);
+        Bitmap& b = bitmaps_[i];
+        if((--b.pins == 0) && (b.source == nullptr))
+        {
+          release(b); // evicted while pinned
+        }
+      }
+    }
+  }
+
+  void predecode(const void* const* sources, uint8_t count)
+  {
+    for(uint8_t i = 0; i < count; i++)
+    {
+      get(sources[i]);
+    }
+  }
+
+  // drops source, e.g. when its data changed
+  void evict(const void* source)
+  {
+    Lock lock(mutex_);
+    Bitmap* b = find(source);
+    if(b != nullptr)
+    {
+      retire(*b);
+    }
+  }
+
+  void clear()
+  {
+    Lock lock(mutex_);
+    for(Bitmap& b : bitmaps_)
+    {
+      if(b.source != nullptr)
+      {
+        retire(b);
+      }
+    }
+  }
+
+  const Stats& stats() const
+  {
+    return stats_;
+  }
+
+  void resetStats()
+  {
+    Lock lock(mutex_);
+    const size_t bytes = stats_.bytes;
+    stats_ = Stats();
+    stats_.bytes = bytes;
+    stats_.peakBytes = bytes;
+  }
+
+private:
+  BitmapCache() :
+    budget_(UWDG_BITMAP_BUDGET),
+    useCount_(0),
+    stats_()
+  {
+    for(Bitmap& b : bitmaps_)
+    {
+      b.source = nullptr;
+      b.pixmap = nullptr;
+      b.pins = 0;
+    }
+  }
+
+  static_assert(UWDG_BITMAPS <= 32, "pin masks are 32 bits");
+
+  // slots evicted while pinned keep their pixmap, but no source
+  Bitmap* find(const void* source)
+  {
+    for(Bitmap& b : bitmaps_)
+    {
+      if((b.source == source) && (b.pixmap != nullptr))
+      {
+        return &b;
+      }
+    }
+    return nullptr;
+  }
+
+  Bitmap* freeSlot()
+  {
+    for(Bitmap& b : bitmaps_)
+    {
+      if(b.pixmap == nullptr)
+      {
+        return &b;
+      }
+    }
+    return nullptr;
+  }
+
+  Bitmap* decode(const void* source)
+  {
+    const systemticks_t begin = gfxSystemTicks();
+    gdispImage img;
+    gdispImageInit(&img);
+    if(gdispImageOpenMemory(&img, source) != GDISP_IMAGE_ERR_OK)
+    {
+      stats_.failures++;
+      return nullptr;
+    }
+    const size_t bytes = (size_t)img.width * img.height * sizeof(pixel_t);
+    Bitmap* b = nullptr;
+    if(bytes <= budget_)
+    {
+      while(((stats_.bytes + bytes > budget_) || ((b = freeSlot()) == nullptr)) &&
+            evictOldest())
+      {
+      }
+      if((stats_.bytes + bytes > budget_) || (b == nullptr))
+      {
+        b = nullptr; // the rest is pinned
+      }
+      else
+      {
+        b->pixmap = gdispPixmapCreate(img.width, img.height);
+      }
+    }
+    if((b == nullptr) || (b->pixmap == nullptr))
+    {
+      gdispImageClose(&img);
+      stats_.failures++;
+      return nullptr;
+    }
+    gdispGImageDraw(b->pixmap, &img, 0, 0, img.width, img.height, 0, 0);
+    gdispImageClose(&img);
+    b->source = source;
+    b->bits = gdispPixmapGetBits(b->pixmap);
+    b->width = img.width;
+    b->height = img.height;
+    b->pins = 0;
+    stats_.bytes += bytes;
+    stats_.peakBytes = stats_.bytes > stats_.peakBytes ? stats_.bytes : stats_.peakBytes;
+    stats_.decodeTicks += gfxSystemTicks() - begin;
+    return b;
+  }
+
+  // returns false if all bitmaps are pinned
+  bool evictOldest()
+  {
+    Bitmap* oldest = nullptr;
+    for(Bitmap& b : bitmaps_)
+    {
+      if((b.source != nullptr) && (b.pins == 0) &&
+         ((oldest == nullptr) || (b.lastUse < oldest->lastUse)))
+      {
+        oldest = &b;
+      }
+    }
+    if(oldest == nullptr)
+    {
+      return false;
+    }
+    release(*oldest);
+    stats_.evictions++;
+    return true;
+  }
+
+  // releases b now, or when its last pin is released
+  void retire(Bitmap& b)
+  {
+    if(b.pins == 0)
+    {
+      release(b);
+    }
+    else
+    {
+      b.source = nullptr;
+    }
+  }
+
+  void release(Bitmap& b)
+  {
+    stats_.bytes -= b.bytes();
+    gdispPixmapDelete(b.pixmap);
+    b.pixmap = nullptr;
+    b.source = nullptr;
+  }
+
+  Bitmap bitmaps_[UWDG_BITMAPS];
+  size_t budget_;
+  uint32_t useCount_;
+  Stats stats_;
+  Mutex mutex_;
+};
+#endif // GDISP_NEED_IMAGE && GDISP_NEED_PIXMAP
+
+} // namespace uwdg
+
+#endif // UWDG_BITMAPCACHE_H
@@ -1,20 +1,16 @@
 #ifndef UWDG_BUTTON_H
 #define UWDG_BUTTON_H
 
+#include "delegate.h"
 #include "label.h"
 
-/* removed in "simple" version
-#include <Signals/Signals.h>
-*/
-
 namespace uwdg
 {
 class Button : public Label
 {
 public:
   Button(Widget* parent = nullptr) :
-    Label(parent),
-    onClicked_(nullptr)
+    Label(parent)
   {
     setAcceptsFocus(true);
   }
@@ -24,9 +20,13 @@ public:
     setAcceptsFocus(true);
     setAlignment(Alignment::center);
   }
-  void draw() const override
+  uint8_t classId() const override
+  {
+    return eClassButton;
+  }
+  void draw(RenderContext& rc) const override
   {
-    Label::draw();
+    Label::draw(rc);
     PRINTDEBUG(("Button(@%p)::draw()\n", this));
   }
   void onInputEvent(InputEvent& event)
@@ -35,25 +35,20 @@ public:
     {
 //      Serial.println("Button clicked");
       event.accept();
-      //clicked();
-      if(onClicked_ != nullptr)
-      {
-        onClicked_();
-			}
+      clicked();
     }
   }
-  /* removed in "simple" version
   Signal<> clicked;
-  */
-  typedef void (*TCallback)();
+  typedef Signal<>::Slot TCallback;
+  // replaces all connections to clicked by f
   void setOnClicked(TCallback f)
 	{
-		onClicked_ = f;
+		clicked.disconnectAll();
+		clicked.connect(f);
 	}
 protected:
 
 private:
-  TCallback onClicked_;
 };
 
 } // namespace uwdg
@@ -0,0 +1,60 @@
+#ifndef UWDG_CACHEPINS_H
+#define UWDG_CACHEPINS_H
+
+#include <stdint.h>
+
+#include "bitmapCache.h"
+#include "subtreeCache.h"
+
+namespace uwdg
+{
+
+/* The cache entries a frame draws from, one bit per BitmapCache and
+  SubtreeCache slot.
+
+  Each RenderContext holds pins for the cached pixmaps it still needs after
+  a draw call and releases them when it's destroyed. A recording context adds them to its DrawList
+  instead, which keeps them until it's cleared or destroyed, so the blits it
+  recorded can't be freed before the list is replayed.
+*/
+class CachePins
+{
+public:
+  CachePins() :
+    bitmaps(0),
+    subtrees(0)
+  {
+  }
+
+  ~CachePins()
+  {
+    release();
+  }
+
+  void release()
+  {
+#if GDISP_NEED_IMAGE && GDISP_NEED_PIXMAP
+    if(bitmaps != 0)
+    {
+      BitmapCache::instance().unpin(bitmaps);
+    }
+#endif // GDISP_NEED_IMAGE && GDISP_NEED_PIXMAP
+#if GDISP_NEED_PIXMAP
+    if(subtrees != 0)
+    {
+      SubtreeCache::instance().unpin(subtrees);
+    }
+#endif // GDISP_NEED_PIXMAP
+  }
+
+  uint32_t bitmaps;
+  uint32_t subtrees;
+
+private:
+  CachePins(const CachePins&);
+  CachePins& operator=(const CachePins&);
+};
+
+} // namespace uwdg
+
+#endif // UWDG_CACHEPINS_H
@@ -0,0 +1,232 @@
+#ifndef UWDG_DELEGATE_H
+#define UWDG_DELEGATE_H
+
+#include <stddef.h>
+#include <string.h>
+#include <new>
+#include <type_traits>
+
+// bytes available for a bound callable (object pointer + member function
+// pointer fit on all common ABIs)
+#ifndef UWDG_DELEGATE_SIZE
+#define UWDG_DELEGATE_SIZE (3 * sizeof(void*))
+#endif
+
+// number of slots per Signal
+#ifndef UWDG_SIGNAL_SLOTS
+#define UWDG_SIGNAL_SLOTS 2
+#endif
+
+namespace uwdg
+{
+
+/* Callable reference without heap allocation.
+
+  A Delegate stores a free function, an (object, member function) pair or a
+  small trivially copyable function object (e.g. a lambda capturing a pointer
+  or two) in a fixed buffer. Calling it costs one indirect call to a stub that
+  forwards to the target.
+
+  Delegates are equal if they call the same function, or the same member
+  function on the same object. Function objects have no comparison of their
+  own, they are equal if they are of the same type and hold the same bytes,
+  which is true for copies of a delegate.
+*/
+template <typename Signature>
+class Delegate;
+
+template <typename R, typename... Args>
+class Delegate<R(Args...)>
+{
+public:
+  Delegate() : stub_(nullptr), equal_(nullptr)
+  {
+  }
+
+  Delegate(std::nullptr_t) : stub_(nullptr), equal_(nullptr)
+  {
+  }
+
+  Delegate(R (*f)(Args...)) : stub_(nullptr), equal_(nullptr)
+  {
+    if(f != nullptr)
+    {
+      store(f);
+    }
+  }
+
+  template <typename T>
+  Delegate(T* object, R (T::*method)(Args...)) : stub_(nullptr), equal_(nullptr)
+  {
+    store(Member<T>(object, method));
+  }
+
+  template <typename T>
+  Delegate(const T* object, R (T::*method)(Args...) const) : stub_(nullptr), equal_(nullptr)
+  {
+    store(ConstMember<T>(object, method));
+  }
+
+  template <typename F,
+            typename = typename std::enable_if<
+              !std::is_same<typename std::decay<F>::type, Delegate>::value>::type>
+  Delegate(const F& f) : stub_(nullptr), equal_(nullptr)
+  {
+    store(f);
+  }
+
+  R operator()(Args... args) const
+  {
+    return stub_(storage_, args...);
+  }
+
+  explicit operator bool() const
+  {
+    return stub_ != nullptr;
+  }
+
+  bool operator==(const Delegate& rhs) const
+  {
+    // the same stub means the same stored type
+    return (stub_ == rhs.stub_) && ((stub_ == nullptr) || equal_(storage_, rhs.storage_));
+  }
+
+  bool operator!=(const Delegate& rhs) const
+  {
+    return !(*this == rhs);
+  }
+
+private:
+  typedef R (*Stub)(const void*, Args...);
+  typedef bool (*Equal)(const void*, const void*);
+  typedef R (*Function)(Args...);
+
+  template <typename T>
+  struct Member
+  {
+    Member(T* o, R (T::*m)(Args...)) : object(o), method(m) {}
+    R operator()(Args... args) const {return (object->*method)(args...);}
+    T* object;
+    R (T::*method)(Args...);
+  };
+
+  template <typename T>
+  struct ConstMember
+  {
+    ConstMember(const T* o, R (T::*m)(Args...) const) : object(o), method(m) {}
+    R operator()(Args... args) const {return (object->*method)(args...);}
+    const T* object;
+    R (T::*method)(Args...) const;
+  };
+
+  template <typename F>
+  static R invoke(const void* p, Args... args)
+  {
+    return (*static_cast<const F*>(p))(args...);
+  }
+
+  // compare the fields, the bytes in between may differ
+  static bool same(const Function& a, const Function& b)
+  {
+    return a == b;
+  }
+
+  template <typename T>
+  static bool same(const Member<T>& a, const Member<T>& b)
+  {
+    return (a.object == b.object) && (a.method == b.method);
+  }
+
+  template <typename T>
+  static bool same(const ConstMember<T>& a, const ConstMember<T>& b)
+  {
+    return (a.object == b.object) && (a.method == b.method);
+  }
+
+  template <typename F>
+  static bool same(const F& a, const F& b)
+  {
+    return memcmp(&a, &b, sizeof(F)) == 0;
+  }
+
+  template <typename F>
+  static bool equal(const void* a, const void* b)
+  {
+    return same(*static_cast<const F*>(a), *static_cast<const F*>(b));
+  }
+
+  template <typename F>
+  void store(const F& f)
+  {
+    static_assert(sizeof(F) <= UWDG_DELEGATE_SIZE,
+                  "callable too large for Delegate, see UWDG_DELEGATE_SIZE");
+    static_assert(std::is_trivially_copyable<F>::value,
+                  "Delegate only binds trivially copyable callables");
+    new (storage_) F(f);
+    stub_ = &invoke<F>;
+    equal_ = &equal<F>;
+  }
+
+  Stub stub_;
+  Equal equal_;
+  alignas(void*) unsigned char storage_[UWDG_DELEGATE_SIZE];
+};
+
+/* A fixed number of delegates that are called in connection order. */
+template <typename... Args>
+class Signal
+{
+public:
+  typedef Delegate<void(Args...)> Slot;
+
+  // returns false if all slots are taken
+  bool connect(const Slot& slot)
+  {
+    for(Slot& s : slots_)
+    {
+      if(!s)
+      {
+        s = slot;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void disconnect(const Slot& slot)
+  {
+    for(Slot& s : slots_)
+    {
+      if(s && (s == slot))
+      {
+        s = Slot();
+      }
+    }
+  }
+
+  void disconnectAll()
+  {
+    for(Slot& s : slots_)
+    {
+      s = Slot();
+    }
+  }
+
+  void operator()(Args... args) const
+  {
+    for(const Slot& s : slots_)
+    {
+      if(s)
+      {
+        s(args...);
+      }
+    }
+  }
+
+private:
+  Slot slots_[UWDG_SIGNAL_SLOTS];
+};
+
+} // namespace uwdg
+
+#endif // UWDG_DELEGATE_H
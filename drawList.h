@@ -0,0 +1,339 @@
+#ifndef UWDG_DRAWLIST_H
+#define UWDG_DRAWLIST_H
+
+#include <stddef.h>
+
+#include "cachePins.h"
+#include "geometry.h"
+#include "style.h"
+
+namespace uwdg
+{
+
+/* A recorded sequence of drawing primitives.
+
+  A RenderContext that is given a DrawList appends primitives to it instead of
+  sending them to the display. The list can then be optimized (hidden
+  primitives dropped, neighbouring fills of the same color merged) and
+  replayed in one pass, as often as needed: replaying does not touch the
+  widget tree. Recorded strings and bitmaps are referenced, not copied, so a
+  list must be replayed before the recorded texts change. Cached bitmaps it
+  blits are pinned until the list is cleared (see CachePins), so lists
+  should be cleared once they have been replayed.
+
+  Storage is provided by the user, usually through StaticDrawList<N>. When the
+  list runs full while recording, what has been recorded so far is drawn right
+  away to keep the drawing order intact, and the list can't be replayed as a
+  whole afterwards (see complete()).
+*/
+class DrawList
+{
+public:
+  struct Command
+  {
+    enum Type
+    {
+      eFill,
+      eBox,
+      eString,
+      eLine,
+      eFillArc,
+      eBlit
+    };
+    uint8_t type;
+    uint8_t justify;
+    Color color;
+    Rectangle area; // absolute, bounding box for lines and arcs
+    Rectangle clip; // absolute
+    union
+    {
+      const char* text;
+      const pixel_t* bits; // eBlit
+    };
+    Font font;
+    // eLine: absolute end points (x0,y0), (x1,y1)
+    // eFillArc: absolute center (x0,y0), angles x1 to y1; area bounds the circle
+    // eBlit: source position (x0,y0), source line length x1
+    Coordinate x0;
+    Coordinate y0;
+    Coordinate x1;
+    Coordinate y1;
+  };
+
+  DrawList(Command* buffer, size_t capacity) :
+    commands_(buffer),
+    capacity_(capacity),
+    size_(0),
+    display_(nullptr),
+    complete_(true)
+  {
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  size_t capacity() const
+  {
+    return capacity_;
+  }
+
+  const Command& operator[](size_t i) const
+  {
+    return commands_[i];
+  }
+
+  // false if commands had to be flushed while recording
+  bool complete() const
+  {
+    return complete_;
+  }
+
+  // also releases the pinned cache entries
+  void clear()
+  {
+    size_ = 0;
+    complete_ = true;
+    pins_.release();
+  }
+
+  // the cache entries the recorded commands refer to
+  CachePins& pins()
+  {
+    return pins_;
+  }
+
+  /* Draws what has been recorded so far to g and starts over, e.g. when the
+    list runs full or its pins keep a cache from making room. The list can't
+    be replayed as a whole afterwards.
+  */
+  void flush(GDisplay* g)
+  {
+    replay(g);
+    size_ = 0;
+    complete_ = false;
+    pins_.release();
+  }
+
+  // returns the stored copy of c
+  Command* add(GDisplay* g, const Command& c)
+  {
+    if(size_ == capacity_)
+    {
+      flush(g);
+    }
+    display_ = g;
+    commands_[size_] = c;
+    if(c.type == Command::eFill)
+    {
+      // a fill doesn't need a clip once it's clipped itself
+      commands_[size_].area &= c.clip;
+      commands_[size_].clip = commands_[size_].area;
+    }
+    return &commands_[size_++];
+  }
+
+  /* Removes commands that are completely painted over by a later fill and
+    merges fills of the same color that share an edge, as long as the merge
+    doesn't change the drawing order relative to anything in between.
+  */
+  void optimize()
+  {
+    for(size_t i = 0; i < size_; i++)
+    {
+      Rectangle a = commands_[i].area & commands_[i].clip;
+      for(size_t j = i + 1; j < size_; j++)
+      {
+        if((commands_[j].type == Command::eFill) && commands_[j].area.contains(a))
+        {
+          commands_[i].area.size = Size(0, 0);
+          break;
+        }
+      }
+    }
+    compact();
+
+    bool merged = true;
+    while(merged)
+    {
+      merged = false;
+      for(size_t i = 0; i < size_; i++)
+      {
+        if(commands_[i].type != Command::eFill)
+        {
+          continue;
+        }
+        for(size_t j = i + 1; j < size_; j++)
+        {
+          if((commands_[j].type == Command::eFill) &&
+             (commands_[j].color == commands_[i].color) &&
+             adjacent(commands_[i].area, commands_[j].area) &&
+             untouchedBetween(i, j, commands_[j].area))
+          {
+            // draw j's pixels together with i's
+            commands_[i].area = bounds(commands_[i].area, commands_[j].area);
+            commands_[i].clip = commands_[i].area;
+            commands_[j].area.size = Size(0, 0);
+            merged = true;
+          }
+        }
+      }
+      compact();
+    }
+  }
+
+  // issues all recorded commands to g
+  void replay(GDisplay* g) const
+  {
+    replay(g, Rectangle(Point(0, 0), Size(gdispGGetWidth(g), gdispGGetHeight(g))));
+  }
+
+  /* Issues the part of the recorded frame inside window to g, with
+    window.p0 moved to g's origin. Used to rasterize tiles into separate
+    pixmaps; every pixel comes out as it would when replaying to the whole
+    display.
+  */
+  void replay(GDisplay* g, const Rectangle& window) const
+  {
+    const Coordinate dx = -window.p0.x;
+    const Coordinate dy = -window.p0.y;
+    Rectangle applied;
+    bool appliedValid = false;
+    for(size_t i = 0; i < size_; i++)
+    {
+      const Command& c = commands_[i];
+      const Rectangle clip = c.clip & window;
+      Rectangle a = c.area & clip;
+      if(a.empty())
+      {
+        continue;
+      }
+      if(!appliedValid || !((a == c.area) && applied.contains(c.area)))
+      {
+        gdispGSetClip(g, clip.p0.x + dx, clip.p0.y + dy, clip.size.w, clip.size.h);
+        applied = clip;
+        appliedValid = true;
+      }
+      Coordinate x = c.area.p0.x + dx;
+      Coordinate y = c.area.p0.y + dy;
+      switch(c.type)
+      {
+        case Command::eFill:
+          gdispGFillArea(g, x, y, c.area.size.w, c.area.size.h, c.color);
+          break;
+        case Command::eBox:
+          gdispGDrawBox(g, x, y, c.area.size.w, c.area.size.h, c.color);
+          break;
+        case Command::eString:
+          gdispGDrawStringBox(g, x, y, c.area.size.w, c.area.size.h,
+                              c.text, c.font, c.color, (justify_t)c.justify);
+          break;
+        case Command::eLine:
+          gdispGDrawLine(g, c.x0 + dx, c.y0 + dy, c.x1 + dx, c.y1 + dy, c.color);
+          break;
+#if GDISP_NEED_ARC
+        case Command::eFillArc:
+          gdispGFillArc(g, c.x0 + dx, c.y0 + dy, (c.area.size.w - 1) / 2, c.x1, c.y1, c.color);
+          break;
+#endif // GDISP_NEED_ARC
+        case Command::eBlit:
+          gdispGBlitArea(g, x, y, c.area.size.w, c.area.size.h, c.x0, c.y0, c.x1, c.bits);
+          break;
+        default:
+          break;
+      }
+    }
+    gdispGSetClip(g, 0, 0, gdispGGetWidth(g), gdispGGetHeight(g));
+  }
+
+  // bounding box of what the recorded commands can touch
+  Rectangle bounds() const
+  {
+    Rectangle r;
+    for(size_t i = 0; i < size_; i++)
+    {
+      r |= commands_[i].area & commands_[i].clip;
+    }
+    return r;
+  }
+
+  // replays to the display the list was recorded for
+  void replay() const
+  {
+    if(display_ != nullptr)
+    {
+      replay(display_);
+    }
+  }
+
+private:
+  static bool adjacent(const Rectangle& a, const Rectangle& b)
+  {
+    if((a.p0.y == b.p0.y) && (a.size.h == b.size.h))
+    {
+      return (a.p0.x + a.size.w == b.p0.x) || (b.p0.x + b.size.w == a.p0.x);
+    }
+    if((a.p0.x == b.p0.x) && (a.size.w == b.size.w))
+    {
+      return (a.p0.y + a.size.h == b.p0.y) || (b.p0.y + b.size.h == a.p0.y);
+    }
+    return false;
+  }
+
+  static Rectangle bounds(const Rectangle& a, const Rectangle& b)
+  {
+    Coordinate left = a.p0.x < b.p0.x ? a.p0.x : b.p0.x;
+    Coordinate top = a.p0.y < b.p0.y ? a.p0.y : b.p0.y;
+    Coordinate right = a.p0.x + a.size.w > b.p0.x + b.size.w ? a.p0.x + a.size.w : b.p0.x + b.size.w;
+    Coordinate bottom = a.p0.y + a.size.h > b.p0.y + b.size.h ? a.p0.y + a.size.h : b.p0.y + b.size.h;
+    return Rectangle(Point(left, top), Size(right - left, bottom - top));
+  }
+
+  // true if no command between i and j draws into r
+  bool untouchedBetween(size_t i, size_t j, const Rectangle& r) const
+  {
+    for(size_t k = i + 1; k < j; k++)
+    {
+      if(!(commands_[k].area & commands_[k].clip & r).empty())
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // drops commands with an empty area
+  void compact()
+  {
+    size_t n = 0;
+    for(size_t i = 0; i < size_; i++)
+    {
+      if(!commands_[i].area.empty())
+      {
+        commands_[n++] = commands_[i];
+      }
+    }
+    size_ = n;
+  }
+
+  Command* commands_;
+  size_t capacity_;
+  size_t size_;
+  GDisplay* display_;
+  bool complete_;
+  CachePins pins_;
+};
+
+template <size_t N>
+class StaticDrawList : public DrawList
+{
+public:
+  StaticDrawList() : DrawList(buffer_, N) {}
+private:
+  Command buffer_[N];
+};
+
+} // namespace uwdg
+
+#endif // UWDG_DRAWLIST_H
@@ -0,0 +1,221 @@
+#ifndef UWDG_FONTS_H
+#define UWDG_FONTS_H
+
+#include <gfx.h>
+#include <string.h>
+
+#include "lock.h"
+
+// number of fonts the registry can hold
+#ifndef UWDG_FONTS
+#define UWDG_FONTS 8
+#endif
+
+// name of font 0, which styles use by default
+#ifndef UWDG_DEFAULT_FONT
+#define UWDG_DEFAULT_FONT "UI2"
+#endif
+
+namespace uwdg
+{
+typedef font_t Font;
+typedef uint8_t FontId;
+
+struct FontMetrics
+{
+  coord_t lineHeight;
+  coord_t averageWidth;
+  coord_t minWidth;
+  coord_t maxWidth;
+
+  bool monospace() const
+  {
+    return minWidth == maxWidth;
+  }
+};
+
+/* Fonts by name, opened on first use.
+
+  Styles refer to fonts by FontId, so no font is opened before it is needed
+  (in particular not during static initialization, before gfxInit()), and all
+  styles using the same name share one handle. Fonts declared with preload
+  are opened one at a time on idle frames, which Widget::drawWidgets() does
+  via preloadStep(), so the first frame isn't delayed by fonts it doesn't
+  show. Metrics are read once when a font is opened.
+
+  A name that can't be opened is resolved to the default font once and not
+  tried again until closeAll(). The registry is locked, so passes for
+  different displays can open fonts from different threads.
+
+  Names are not copied and must stay valid. Font 0 is the default font.
+*/
+class FontRegistry
+{
+public:
+  static constexpr FontId defaultId = 0;
+  static constexpr FontId invalid = 0xFF;
+
+  static FontRegistry& instance()
+  {
+    static FontRegistry r_;
+    return r_;
+  }
+
+  // registers name without opening it; returns the id of a known name
+  FontId declare(const char* name, bool preload = false)
+  {
+    Lock lock(mutex_);
+    for(FontId i = 0; i < count_; i++)
+    {
+      if(strcmp(entries_[i].name, name) == 0)
+      {
+        entries_[i].preload |= preload;
+        return i;
+      }
+    }
+    if(count_ == UWDG_FONTS)
+    {
+      return invalid;
+    }
+    Entry& e = entries_[count_];
+    e.name = name;
+    e.font = nullptr;
+    e.preload = preload;
+    e.resolved = false;
+    e.shared = false;
+    return count_++;
+  }
+
+  // unknown ids give the default font
+  Font font(FontId id)
+  {
+    Lock lock(mutex_);
+    return open(id).font;
+  }
+
+  Font font(const char* name)
+  {
+    return font(declare(name));
+  }
+
+  const FontMetrics& metrics(FontId id)
+  {
+    Lock lock(mutex_);
+    return open(id).metrics;
+  }
+
+  // id of an open handle, invalid for fonts opened elsewhere
+  FontId find(Font f) const
+  {
+    Lock lock(mutex_);
+    for(FontId i = 0; i < count_; i++)
+    {
+      if((entries_[i].font == f) && (f != nullptr))
+      {
+        return i;
+      }
+    }
+    return invalid;
+  }
+
+  // true if the font was opened, false if not yet or it failed
+  bool isOpen(FontId id) const
+  {
+    Lock lock(mutex_);
+    return (id < count_) && entries_[id].resolved && !entries_[id].shared &&
+           (entries_[id].font != nullptr);
+  }
+
+  // opens the next font declared for preloading, returns false when done
+  bool preloadStep()
+  {
+    Lock lock(mutex_);
+    for(FontId i = 0; i < count_; i++)
+    {
+      if(entries_[i].preload && !entries_[i].resolved)
+      {
+        open(i);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // closes all fonts, they are reopened when used again
+  void closeAll()
+  {
+    Lock lock(mutex_);
+    for(FontId i = 0; i < count_; i++)
+    {
+      Entry& e = entries_[i];
+      if(!e.shared && (e.font != nullptr))
+      {
+        gdispCloseFont(e.font);
+      }
+      e.font = nullptr;
+      e.resolved = false;
+      e.shared = false;
+    }
+  }
+
+private:
+  struct Entry
+  {
+    const char* name;
+    Font font;
+    FontMetrics metrics;
+    bool preload;
+    bool resolved; // opened, or failed and resolved to the default font
+    bool shared;   // font is the default font's handle
+  };
+
+  FontRegistry() :
+    count_(0)
+  {
+    declare(UWDG_DEFAULT_FONT);
+  }
+
+  // needs the lock
+  Entry& open(FontId id)
+  {
+    Entry& e = entries_[id < count_ ? id : defaultId];
+    if(!e.resolved)
+    {
+      e.resolved = true;
+      e.font = gdispOpenFont(e.name);
+      if(e.font != nullptr)
+      {
+        measure(e);
+      }
+      else if(&e != &entries_[defaultId])
+      {
+        // unknown name: share the default font's handle and metrics
+        Entry& d = open(defaultId);
+        e.font = d.font;
+        e.metrics = d.metrics;
+        e.shared = true;
+      }
+      else
+      {
+        e.metrics = FontMetrics();
+      }
+    }
+    return e;
+  }
+
+  static void measure(Entry& e)
+  {
+    static const char sample[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    e.metrics.lineHeight = gdispGetFontMetric(e.font, fontLineSpacing);
+    e.metrics.averageWidth = gdispGetStringWidth(sample, e.font) / (sizeof(sample) - 1);
+    e.metrics.minWidth = gdispGetFontMetric(e.font, fontMinWidth);
+    e.metrics.maxWidth = gdispGetFontMetric(e.font, fontMaxWidth);
+  }
+
+  Entry entries_[UWDG_FONTS];
+  FontId count_;
+  mutable Mutex mutex_;
+};
+} // namespace uwdg
+
+#endif // UWDG_FONTS_H
@@ -0,0 +1,162 @@
+#ifndef UWDG_GAUGE_H
+#define UWDG_GAUGE_H
+
+#include "valueWidget.h"
+
+namespace uwdg
+{
+
+/* Half-circle gauge, from the minimum on the left to the maximum on the right.
+
+  As eSector it fills the sector between the minimum and the value, as
+  eNeedle it draws a needle pointing at the value. Value changes only paint
+  the sector between the previously drawn and the new angle, or erase the old
+  needle and draw the new one. eSector needs GDISP_NEED_ARC.
+*/
+class Gauge : public ValueWidget
+{
+public:
+  enum Kind
+  {
+    eSector,
+    eNeedle
+  };
+
+  Gauge(Widget* parent = nullptr) :
+    ValueWidget(parent),
+    kind_(eNeedle),
+    drawnAngle_(180)
+  {
+  }
+
+  Kind kind() const
+  {
+    return kind_;
+  }
+
+  void setKind(Kind k)
+  {
+    if(k != kind_)
+    {
+      kind_ = k;
+      redraw();
+    }
+  }
+
+  virtual void draw(RenderContext& rc) const override
+  {
+    Widget::draw(rc);
+    if(kind_ == eNeedle)
+    {
+      drawnAngle_ = angle();
+      drawNeedle(rc, drawnAngle_, colorSet().text);
+    }
+    else
+    {
+      drawnAngle_ = 180;
+      paintSector(rc, angle());
+    }
+  }
+
+  virtual bool drawUpdate(RenderContext& rc) override
+  {
+    Coordinate a = angle();
+    if(a == drawnAngle_)
+    {
+      return true;
+    }
+    if(kind_ == eNeedle)
+    {
+      drawNeedle(rc, drawnAngle_, colorSet().fill);
+      drawNeedle(rc, a, colorSet().text);
+      drawnAngle_ = a;
+    }
+    else
+    {
+      paintSector(rc, a);
+    }
+    return true;
+  }
+
+private:
+  // degrees, counter-clockwise from 3 o'clock
+  Coordinate angle() const
+  {
+    return 180 - scale(value(), 180);
+  }
+
+  Point center() const
+  {
+    return Point(width() / 2, height() - 2);
+  }
+
+  Length radius() const
+  {
+    Coordinate rx = width() / 2 - 2;
+    Coordinate ry = height() - 3;
+    Coordinate r = rx < ry ? rx : ry;
+    return r > 0 ? r : 0;
+  }
+
+  // sin(a) * 2^14 for a in degrees
+  static int32_t sin14(Coordinate a)
+  {
+    // sin at 0, 5, ..., 90 degrees
+    static const int16_t table[19] = {
+      0, 1428, 2845, 4240, 5604, 6924, 8192, 9397, 10531, 11585,
+      12551, 13421, 14189, 14849, 15396, 15826, 16135, 16322, 16384
+    };
+    a %= 360;
+    a = a < 0 ? a + 360 : a;
+    int32_t sign = 1;
+    if(a >= 180)
+    {
+      a -= 180;
+      sign = -1;
+    }
+    a = a > 90 ? 180 - a : a;
+    int32_t i = a / 5;
+    int32_t f = a % 5;
+    int32_t v = table[i] + (f != 0 ? ((table[i + 1] - table[i]) * f) / 5 : 0);
+    return sign * v;
+  }
+
+  void drawNeedle(RenderContext& rc, Coordinate a, Color c) const
+  {
+    const Point p = center();
+    const int32_t r = radius();
+    Coordinate x = p.x + ((sin14(a + 90) * r) >> 14);
+    Coordinate y = p.y - ((sin14(a) * r) >> 14);
+    rc.drawLine(p.x, p.y, x, y, c);
+  }
+
+  // fills or clears the sector between drawnAngle_ and a
+  void paintSector(RenderContext& rc, Coordinate a) const
+  {
+#if GDISP_NEED_ARC
+    if(a == drawnAngle_)
+    {
+      return;
+    }
+    const Point p = center();
+    if(a < drawnAngle_)
+    {
+      rc.fillArc(p.x, p.y, radius(), a, drawnAngle_, colorSet().text);
+    }
+    else
+    {
+      // both angles are inclusive: the sector keeps the ray at a, unless
+      // it's empty at the minimum
+      rc.fillArc(p.x, p.y, radius(), drawnAngle_, a < 180 ? a - 1 : a, colorSet().fill);
+    }
+    drawnAngle_ = a;
+#endif // GDISP_NEED_ARC
+  }
+
+  Kind kind_;
+  mutable Coordinate drawnAngle_;
+};
+
+} // namespace uwdg
+
+#endif // UWDG_GAUGE_H
@@ -56,6 +56,47 @@ struct Rectangle
     return *this;
   }
   const Rectangle operator&(const Rectangle& rhs) const {return Rectangle(*this) &= rhs;}
+  // bounding box, empty rectangles are ignored
+  Rectangle& operator |= (const Rectangle& rhs)
+  {
+    if(rhs.empty())
+    {
+      return *this;
+    }
+    if(empty())
+    {
+      return *this = rhs;
+    }
+    Coordinate left = std::min(p0.x, rhs.p0.x);
+    Coordinate right = std::max(p0.x + size.w, rhs.p0.x + rhs.size.w);
+    Coordinate top = std::min(p0.y, rhs.p0.y);
+    Coordinate bottom = std::max(p0.y + size.h, rhs.p0.y + rhs.size.h);
+    p0.x = left;
+    p0.y = top;
+    size.w = right-left;
+    size.h = bottom-top;
+    return *this;
+  }
+  const Rectangle operator|(const Rectangle& rhs) const {return Rectangle(*this) |= rhs;}
+  bool operator==(const Rectangle& rhs) const
+  {
+    return (p0.x == rhs.p0.x) && (p0.y == rhs.p0.y) &&
+           (size.w == rhs.size.w) && (size.h == rhs.size.h);
+  }
+  bool operator!=(const Rectangle& rhs) const {return !(*this == rhs);}
+
+  bool empty() const
+  {
+    return (size.w == 0) || (size.h == 0);
+  }
+
+  // true if r lies completely inside this rectangle
+  bool contains(const Rectangle& r) const
+  {
+    return (r.p0.x >= p0.x) && (r.p0.y >= p0.y) &&
+           (r.p0.x + r.size.w <= p0.x + size.w) &&
+           (r.p0.y + r.size.h <= p0.y + size.h);
+  }
 
   Point p0;
   Size size;
@@ -0,0 +1,152 @@
+#ifndef UWDG_IMAGE_H
+#define UWDG_IMAGE_H
+
+#include "bitmapCache.h"
+#include "button.h"
+#include "widget.h"
+
+namespace uwdg
+{
+
+#if GDISP_NEED_IMAGE && GDISP_NEED_PIXMAP
+/* Shows an image from the BitmapCache, centered in the widget. Transparent
+  images only draw the image itself.
+*/
+class Image : public Widget
+{
+public:
+  Image(const void* source = nullptr, Widget* parent = nullptr) :
+    Widget(parent),
+    source_(source)
+  {
+  }
+
+  const void* source() const
+  {
+    return source_;
+  }
+
+  void setSource(const void* source)
+  {
+    if(source != source_)
+    {
+      source_ = source;
+      redraw();
+    }
+  }
+
+  virtual uint8_t classId() const override
+  {
+    return eClassOther;
+  }
+
+  virtual void draw(RenderContext& rc) const override
+  {
+    Widget::draw(rc);
+    drawBitmap(rc, bitmap(rc, source_), Rectangle(Point(0, 0), size()));
+  }
+
+  /* The cached image of source, nullptr if there is none. The bitmap is
+    pinned to rc, so passes on other displays can't free it before it's
+    blitted, and a recorded blit keeps it until the list is replayed. If the
+    pins take up the whole cache, rc is flushed to release them.
+  */
+  static const BitmapCache::Bitmap* bitmap(RenderContext& rc, const void* source)
+  {
+    if(source == nullptr)
+    {
+      return nullptr;
+    }
+    BitmapCache& cache = BitmapCache::instance();
+    uint32_t& pins = rc.pins().bitmaps;
+    const BitmapCache::Bitmap* b = cache.get(source, &pins);
+    if((b == nullptr) && (pins != 0))
+    {
+      rc.flush();
+      b = cache.get(source, &pins);
+    }
+    return b;
+  }
+
+  // blits b centered into area (relative)
+  static void drawBitmap(RenderContext& rc, const BitmapCache::Bitmap* b, const Rectangle& area)
+  {
+    if(b == nullptr)
+    {
+      return;
+    }
+    rc.blitArea(area.p0.x + (area.size.w - b->width) / 2,
+                area.p0.y + (area.size.h - b->height) / 2,
+                b->width, b->height, 0, 0, b->width, b->bits);
+  }
+
+private:
+  const void* source_;
+};
+
+/* Button with an icon on the left of its text, or centered if the text is
+  empty.
+*/
+class IconButton : public Button
+{
+public:
+  IconButton(const void* icon, const char* s, Widget* parent = nullptr) :
+    Button(s, parent),
+    icon_(icon)
+  {
+  }
+
+  const void* icon() const
+  {
+    return icon_;
+  }
+
+  void setIcon(const void* icon)
+  {
+    if(icon != icon_)
+    {
+      icon_ = icon;
+      redraw();
+    }
+  }
+
+  // not representable in screen images
+  virtual uint8_t classId() const override
+  {
+    return eClassOther;
+  }
+
+  // the text isn't laid out like in a Label
+  virtual bool drawUpdate(RenderContext& /*rc*/) override
+  {
+    return false;
+  }
+
+  void draw(RenderContext& rc) const override
+  {
+    Widget::draw(rc);
+    const BitmapCache::Bitmap* b = Image::bitmap(rc, icon_);
+    if(text()[0] == '\0')
+    {
+      Image::drawBitmap(rc, b, Rectangle(Point(0, 0), size()));
+      return;
+    }
+    Length iconWidth = 0;
+    if(b != nullptr)
+    {
+      Image::drawBitmap(rc, b, Rectangle(Point(padding, 0), Size(b->width, height())));
+      iconWidth = b->width + padding;
+    }
+    rc.drawStringBox(padding + iconWidth, 0, width() - 2 * padding - iconWidth, height(),
+                     text(), font(), colorSet().text, (justify_t)alignment());
+  }
+
+private:
+  static constexpr Length padding = 2;
+  const void* icon_;
+};
+#endif // GDISP_NEED_IMAGE && GDISP_NEED_PIXMAP
+
+} // namespace uwdg
+
+#endif // UWDG_IMAGE_H
@@ -1,6 +1,8 @@
 #ifndef INPUTEVENT_H
 #define INPUTEVENT_H
 
+#include <gfx.h>
+
 class InputEvent
 {
 	public:
@@ -12,11 +14,32 @@ class InputEvent
       eDown,
       eEnter,
       eCW,
-      eCCW
+      eCCW,
+      eNumInputTypes
+    };
+    enum EAction
+    {
+      ePressed,
+      eReleased,
+      eLongPressed
     };
 		InputEvent(const EInputType& inputType, bool down)
       : inputType_(inputType),
-      down_(down),
+      action_(down ? ePressed : eReleased),
+      time_(gfxSystemTicks()),
+      count_(1),
+      repeat_(false),
+      accepted_(false)
+		{
+		}
+
+		InputEvent(const EInputType& inputType, EAction action,
+               systemticks_t time, uint16_t count = 1, bool repeat = false)
+      : inputType_(inputType),
+      action_(action),
+      time_(time),
+      count_(count),
+      repeat_(repeat),
       accepted_(false)
 		{
 //		  Serial.printf("InputEvent(%d, %d)\n", type(), isPress());
@@ -39,11 +62,23 @@ class InputEvent
 		/** Was the event accepted? **/
 		bool accepted() const {return accepted_;}
 
-    /** Was this a button press event? **/
-		bool isPress() const {return down_;}
+    /** Was this a button press event? Also true for auto-repeats **/
+		bool isPress() const {return action_ == ePressed;}
 
     /** Was this a button release event? **/
-		bool isRelease() const {return !down_;}
+		bool isRelease() const {return action_ == eReleased;}
+
+    /** Was the button held down for the long-press time? **/
+		bool isLongPress() const {return action_ == eLongPressed;}
+
+    /** Was this press generated by auto-repeat? **/
+		bool isRepeat() const {return repeat_;}
+
+    /** Number of presses this event stands for (batched repeats) **/
+		uint16_t count() const {return count_;}
+
+    /** System ticks when the input happened **/
+		systemticks_t time() const {return time_;}
 
 //		static Signal<InputEvent&> onInput()
 //		{
@@ -53,7 +88,10 @@ class InputEvent
 
 	protected:
 		const EInputType inputType_;
-		const bool down_;
+		const EAction action_;
+		const systemticks_t time_;
+		const uint16_t count_;
+		const bool repeat_;
 		bool accepted_;
 
 	private:
@@ -0,0 +1,200 @@
+#ifndef UWDG_INPUTFILTER_H
+#define UWDG_INPUTFILTER_H
+
+#include "inputEvent.h"
+#include "widget.h"
+
+namespace uwdg
+{
+
+/* Preprocessing stage between raw key states and Widget::dispatchInputEvent().
+
+  Raw key states are fed in with setKey() (from a polling loop or an interrupt
+  handler, with the time the level was sampled) and process() is called once
+  per frame. It debounces each key, synthesizes auto-repeat with acceleration
+  and long-press events, and dispatches at most one event per key and call:
+  repeats that became due since the last call are batched into a single press
+  with InputEvent::count() > 1.
+
+  Auto-repeat and long-press are enabled per key with bit masks
+  (1 << InputEvent::EInputType). A key should use one or the other.
+*/
+class InputFilter
+{
+public:
+  typedef uint8_t keymask_t;
+
+  InputFilter() :
+    debounce_(gfxMillisecondsToTicks(20)),
+    repeatDelay_(gfxMillisecondsToTicks(500)),
+    repeatInterval_(gfxMillisecondsToTicks(200)),
+    repeatMinInterval_(gfxMillisecondsToTicks(40)),
+    repeatAccel_(205), // interval shrinks to 80% per repeat
+    longPress_(gfxMillisecondsToTicks(800)),
+    repeatKeys_((1 << InputEvent::eLeft) | (1 << InputEvent::eUp) |
+                (1 << InputEvent::eRight) | (1 << InputEvent::eDown)),
+    longPressKeys_(0)
+  {
+    for(Key& k : keys_)
+    {
+      k.raw = false;
+      k.stable = false;
+      k.longPressed = false;
+      k.changed = 0;
+      k.pressed = 0;
+      k.nextRepeat = 0;
+      k.interval = 0;
+    }
+  }
+
+  /*****************************************************************************
+  * Configuration (times in milliseconds)
+  *****************************************************************************/
+  void setDebounce(delaytime_t ms)
+  {
+    debounce_ = gfxMillisecondsToTicks(ms);
+  }
+
+  // accel: factor applied to the interval after each repeat, in 1/256
+  void setRepeat(delaytime_t delay, delaytime_t interval,
+                 delaytime_t minInterval, uint16_t accel = 256)
+  {
+    repeatDelay_ = gfxMillisecondsToTicks(delay);
+    repeatInterval_ = gfxMillisecondsToTicks(interval);
+    repeatMinInterval_ = gfxMillisecondsToTicks(minInterval);
+    repeatAccel_ = accel;
+  }
+
+  void setLongPress(delaytime_t ms)
+  {
+    longPress_ = gfxMillisecondsToTicks(ms);
+  }
+
+  void setRepeatKeys(keymask_t mask)
+  {
+    repeatKeys_ = mask;
+  }
+
+  void setLongPressKeys(keymask_t mask)
+  {
+    longPressKeys_ = mask;
+  }
+
+  /*****************************************************************************
+  * Input
+  *****************************************************************************/
+  void setKey(InputEvent::EInputType type, bool down,
+              systemticks_t time = gfxSystemTicks())
+  {
+    Key& k = keys_[type];
+    if(k.raw != down)
+    {
+      k.raw = down;
+      k.changed = time;
+    }
+  }
+
+  // rotary encoders and other inputs without a level: no debouncing
+  void step(InputEvent::EInputType type, systemticks_t time = gfxSystemTicks())
+  {
+    InputEvent event(type, InputEvent::ePressed, time);
+    Widget::dispatchInputEvent(event);
+  }
+
+  void process(systemticks_t now = gfxSystemTicks())
+  {
+    for(uint8_t i = 0; i < InputEvent::eNumInputTypes; i++)
+    {
+      process(static_cast<InputEvent::EInputType>(i), now);
+    }
+  }
+
+private:
+  struct Key
+  {
+    bool raw;
+    bool stable;
+    bool longPressed;
+    systemticks_t changed;   // last raw edge
+    systemticks_t pressed;   // debounced press
+    systemticks_t nextRepeat;
+    systemticks_t interval;
+  };
+
+  // tick counters wrap, compare differences only
+  static bool reached(systemticks_t now, systemticks_t t)
+  {
+    return static_cast<int32_t>(now - t) >= 0;
+  }
+
+  void process(InputEvent::EInputType type, systemticks_t now)
+  {
+    Key& k = keys_[type];
+    const keymask_t bit = 1 << type;
+    if((k.raw != k.stable) && reached(now, k.changed + debounce_))
+    {
+      k.stable = k.raw;
+      if(k.stable)
+      {
+        k.pressed = k.changed;
+        k.longPressed = false;
+        k.interval = repeatInterval_;
+        k.nextRepeat = k.changed + repeatDelay_;
+        InputEvent event(type, InputEvent::ePressed, k.changed);
+        Widget::dispatchInputEvent(event);
+      }
+      else
+      {
+        InputEvent event(type, InputEvent::eReleased, k.changed);
+        Widget::dispatchInputEvent(event);
+      }
+      return;
+    }
+    if(!k.stable)
+    {
+      return;
+    }
+    if((longPressKeys_ & bit) && !k.longPressed &&
+       reached(now, k.pressed + longPress_))
+    {
+      k.longPressed = true;
+      InputEvent event(type, InputEvent::eLongPressed, k.pressed + longPress_);
+      Widget::dispatchInputEvent(event);
+    }
+    if((repeatKeys_ & bit) && reached(now, k.nextRepeat))
+    {
+      uint16_t count = 0;
+      systemticks_t first = k.nextRepeat;
+      while(reached(now, k.nextRepeat) && (count < 0xFFFF))
+      {
+        count++;
+        k.nextRepeat += k.interval;
+        k.interval = (k.interval * repeatAccel_) >> 8;
+        if(k.interval < repeatMinInterval_)
+        {
+          k.interval = repeatMinInterval_;
+        }
+        if(k.interval == 0)
+        {
+          k.interval = 1;
+        }
+      }
+      InputEvent event(type, InputEvent::ePressed, first, count, true);
+      Widget::dispatchInputEvent(event);
+    }
+  }
+
+  systemticks_t debounce_;
+  systemticks_t repeatDelay_;
+  systemticks_t repeatInterval_;
+  systemticks_t repeatMinInterval_;
+  uint16_t repeatAccel_;
+  systemticks_t longPress_;
+  keymask_t repeatKeys_;
+  keymask_t longPressKeys_;
+  Key keys_[InputEvent::eNumInputTypes];
+};
+
+} // namespace uwdg
+
+#endif // UWDG_INPUTFILTER_H
@@ -42,9 +42,31 @@ public:
 
   void setText(const char* s)
   {
+    if(partialUpdate_)
+    {
+      markChanged(s);
+    }
+    else
+    {
+      redraw();
+    }
     strncpy(buf_, s, LABEL_LEN-1);
     buf_[LABEL_LEN-1] = 0;
-    redraw();
+  }
+
+  /* In partial update mode, setText() only repaints the character cells that
+    changed, which suits clocks and counters. This needs a monospace font and
+    an opaque label; a length change of centered or right aligned text shifts
+    the layout and is repainted completely.
+  */
+  void setPartialUpdate(bool b)
+  {
+    partialUpdate_ = b;
+  }
+
+  bool partialUpdate() const
+  {
+    return partialUpdate_;
   }
 
   Alignment alignment() const
@@ -61,20 +83,124 @@ public:
     }
   }
 
-  virtual void draw() const override
+  virtual uint8_t classId() const override
+  {
+    return eClassLabel;
+  }
+
+  virtual void draw(RenderContext& rc) const override
   {
     PRINTDEBUG(("Label(@%p)::draw()\n", this));
-    Widget::draw();
-    gdispGDrawStringBox(display(), absX(0), absY(0), width(), height(),
-                        text(), font(), colorSet().text, (justify_t)alignment_);
+    Widget::draw(rc);
+    rc.drawStringBox(0, 0, width(), height(),
+                     text(), font(), colorSet().text, (justify_t)alignment_);
+    drawnLength_ = strlen(buf_);
+    changedBegin_ = changedEnd_ = 0;
   }
+
+  virtual bool drawUpdate(RenderContext& rc) override
+  {
+    Length cell;
+    const uint8_t length = strlen(buf_);
+    if(!partialUpdate_ || transparent() || !cellWidth(font(), cell) ||
+       ((length != drawnLength_) && (alignment_ != left)))
+    {
+      return false;
+    }
+    if(changedBegin_ == changedEnd_)
+    {
+      return true;
+    }
+    Coordinate x0 = 0;
+    if(alignment_ == center)
+    {
+      x0 = (width() - length * cell) / 2;
+    }
+    else if(alignment_ == right)
+    {
+      x0 = width() - length * cell;
+    }
+    // the label is drawn again, clipped to the changed cells. One cell of
+    // margin on each side absorbs padding and overhanging glyphs.
+    Rectangle changed(Point(x0 + (changedBegin_ - 1) * cell, 0),
+                      Size((changedEnd_ - changedBegin_ + 2) * cell, height()));
+    {
+      RenderContext::ClipScope scope(rc, changed);
+      Widget::draw(rc);
+      rc.drawStringBox(0, 0, width(), height(),
+                       text(), font(), colorSet().text, (justify_t)alignment_);
+    }
+    drawnLength_ = length;
+    changedBegin_ = changedEnd_ = 0;
+    return true;
+  }
+
 private:
   void reset()
   {
+    buf_[0] = 0;
     alignment_ = Alignment::left;
+    partialUpdate_ = false;
+    drawnLength_ = 0;
+    changedBegin_ = changedEnd_ = 0;
+  }
+
+  // widens the range of changed cells by the difference between buf_ and s
+  void markChanged(const char* s)
+  {
+    uint8_t first = LABEL_LEN;
+    uint8_t last = 0;
+    bool oldEnded = false;
+    bool newEnded = false;
+    for(uint8_t i = 0; (i < LABEL_LEN - 1) && !(oldEnded && newEnded); i++)
+    {
+      const char o = oldEnded ? 0 : buf_[i];
+      const char n = newEnded ? 0 : s[i];
+      if(o != n)
+      {
+        first = i < first ? i : first;
+        last = i + 1;
+      }
+      oldEnded = (o == 0);
+      newEnded = (n == 0);
+    }
+    if(first == LABEL_LEN)
+    {
+      return; // no change
+    }
+    if(changedBegin_ == changedEnd_)
+    {
+      changedBegin_ = first;
+      changedEnd_ = last;
+    }
+    else
+    {
+      changedBegin_ = first < changedBegin_ ? first : changedBegin_;
+      changedEnd_ = last > changedEnd_ ? last : changedEnd_;
+    }
+    update();
   }
+
+  // width of every glyph, false if the font is proportional
+  static bool cellWidth(Font f, Length& cell)
+  {
+    FontRegistry& r = FontRegistry::instance();
+    FontId id = r.find(f);
+    if(id != FontRegistry::invalid)
+    {
+      cell = r.metrics(id).maxWidth;
+      return r.metrics(id).monospace();
+    }
+    cell = gdispGetFontMetric(f, fontMaxWidth);
+    return cell == gdispGetFontMetric(f, fontMinWidth);
+  }
+
   char buf_[LABEL_LEN];
   Alignment alignment_;
+  bool partialUpdate_;
+  mutable uint8_t drawnLength_;
+  mutable uint8_t changedBegin_; // changed character cells since the last draw
+  mutable uint8_t changedEnd_;
 };
 
 } // namespace uwdg
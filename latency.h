@@ -0,0 +1,303 @@
+#ifndef UWDG_LATENCY_H
+#define UWDG_LATENCY_H
+
+#include <gfx.h>
+
+#include "inputEvent.h"
+
+/* Event-to-photon latency tracing, enabled with UWDG_LATENCY_TRACE.
+
+  An input event is timestamped when it is created. While it is dispatched,
+  the tracer notes when focus moves and when the first redraw is requested,
+  and on which display. Events that requested a redraw are kept pending until
+  the next pass on that display that actually draws something, at which point
+  the total latency (input to end of that pass) goes into a fixed-size
+  histogram. Events that didn't cause a redraw aren't traced.
+
+  The tracer is not thread safe: dispatch and drawing must run in the same
+  thread while it's enabled.
+*/
+//#define UWDG_LATENCY_TRACE
+#ifdef UWDG_LATENCY_TRACE
+  #define TRACELATENCY(x) uwdg::LatencyTracer::instance().x
+#else
+  #define TRACELATENCY(x)
+#endif // UWDG_LATENCY_TRACE
+
+// number of events that can wait for the same draw pass
+#ifndef UWDG_LATENCY_PENDING
+#define UWDG_LATENCY_PENDING 8
+#endif
+
+namespace uwdg
+{
+
+/* Histogram of tick counts with two buckets per power of two, i.e. each
+  bucket is at most ~50% wide. Uses 64 counters regardless of the number of
+  samples.
+*/
+class LatencyHistogram
+{
+public:
+  static constexpr uint8_t numBuckets = 64;
+
+  LatencyHistogram()
+  {
+    reset();
+  }
+
+  void reset()
+  {
+    for(uint32_t& c : counts_)
+    {
+      c = 0;
+    }
+    count_ = 0;
+    max_ = 0;
+  }
+
+  void record(systemticks_t ticks)
+  {
+    counts_[bucket(ticks)]++;
+    count_++;
+    if(ticks > max_)
+    {
+      max_ = ticks;
+    }
+  }
+
+  uint32_t count() const
+  {
+    return count_;
+  }
+
+  systemticks_t max() const
+  {
+    return max_;
+  }
+
+  // upper bound of the bucket that contains the given percentile (0..100)
+  systemticks_t percentile(uint8_t p) const
+  {
+    if(count_ == 0)
+    {
+      return 0;
+    }
+    uint32_t rank = (static_cast<uint64_t>(count_) * p + 99) / 100;
+    if(rank == 0)
+    {
+      rank = 1;
+    }
+    uint32_t seen = 0;
+    for(uint8_t i = 0; i < numBuckets; i++)
+    {
+      seen += counts_[i];
+      if(seen >= rank)
+      {
+        systemticks_t high = bucketHigh(i);
+        return high < max_ ? high : max_;
+      }
+    }
+    return max_;
+  }
+
+  systemticks_t p50() const {return percentile(50);}
+  systemticks_t p99() const {return percentile(99);}
+
+  // raw access for exporting
+  uint32_t bucketCount(uint8_t i) const
+  {
+    return counts_[i];
+  }
+
+  static systemticks_t bucketLow(uint8_t i)
+  {
+    if(i < 2)
+    {
+      return i;
+    }
+    uint8_t e = i / 2;
+    systemticks_t base = static_cast<systemticks_t>(1) << e;
+    return (i & 1) ? base + (base >> 1) : base;
+  }
+
+  static systemticks_t bucketHigh(uint8_t i)
+  {
+    return (i + 1 < numBuckets) ? bucketLow(i + 1) - 1 : ~static_cast<systemticks_t>(0);
+  }
+
+private:
+  static uint8_t bucket(systemticks_t v)
+  {
+    if(v < 2)
+    {
+      return v;
+    }
+    uint8_t e = 0;
+    while((v >> (e + 1)) != 0)
+    {
+      e++;
+    }
+    // v is in [2^e, 2^(e+1)), the next bit below the top one selects the half
+    uint8_t half = (v >> (e - 1)) & 1;
+    uint8_t i = 2 * e + half;
+    return i < numBuckets ? i : numBuckets - 1;
+  }
+
+  uint32_t counts_[numBuckets];
+  uint32_t count_;
+  systemticks_t max_;
+};
+
+class LatencyTracer
+{
+public:
+  enum EStage
+  {
+    eDispatched = (1<<0),
+    eFocusChanged = (1<<1),
+    eDamaged = (1<<2),
+    eFlushed = (1<<3)
+  };
+
+  struct Trace
+  {
+    systemticks_t input;
+    systemticks_t dispatched;
+    systemticks_t focusChanged;
+    systemticks_t damaged;
+    systemticks_t flushed;
+    GDisplay* display; // of the first redraw request
+    uint8_t stages; // EStage bits that were reached
+  };
+
+  static LatencyTracer& instance()
+  {
+    static LatencyTracer t_;
+    return t_;
+  }
+
+  /*****************************************************************************
+  * Hooks, called from Widget
+  *****************************************************************************/
+  void beginDispatch(const InputEvent& event)
+  {
+    current_.input = event.time();
+    current_.dispatched = gfxSystemTicks();
+    current_.stages = eDispatched;
+  }
+
+  void focusChanged()
+  {
+    if((current_.stages & eDispatched) && !(current_.stages & eFocusChanged))
+    {
+      current_.focusChanged = gfxSystemTicks();
+      current_.stages |= eFocusChanged;
+    }
+  }
+
+  void damaged(GDisplay* g)
+  {
+    if((current_.stages & eDispatched) && !(current_.stages & eDamaged))
+    {
+      current_.damaged = gfxSystemTicks();
+      current_.display = g;
+      current_.stages |= eDamaged;
+    }
+  }
+
+  void endDispatch()
+  {
+    if(current_.stages & eDamaged)
+    {
+      if(numPending_ < UWDG_LATENCY_PENDING)
+      {
+        pending_[numPending_++] = current_;
+      }
+      else
+      {
+        dropped_++;
+      }
+    }
+    current_.stages = 0;
+  }
+
+  // a draw pass on g has finished, drew is false if it didn't draw anything
+  void flushed(GDisplay* g, bool drew)
+  {
+    if(!drew || (numPending_ == 0))
+    {
+      return;
+    }
+    systemticks_t now = gfxSystemTicks();
+    uint8_t kept = 0;
+    for(uint8_t i = 0; i < numPending_; i++)
+    {
+      if(pending_[i].display != g)
+      {
+        pending_[kept++] = pending_[i]; // waits for its own display
+        continue;
+      }
+      pending_[i].flushed = now;
+      pending_[i].stages |= eFlushed;
+      histogram_.record(now - pending_[i].input);
+      last_ = pending_[i];
+    }
+    numPending_ = kept;
+  }
+
+  // events waiting for a pass on their display
+  uint8_t pending() const
+  {
+    return numPending_;
+  }
+
+  /*****************************************************************************
+  * Results
+  *****************************************************************************/
+  const LatencyHistogram& histogram() const
+  {
+    return histogram_;
+  }
+
+  // the most recently completed trace
+  const Trace& last() const
+  {
+    return last_;
+  }
+
+  // events not traced because too many were pending
+  uint32_t dropped() const
+  {
+    return dropped_;
+  }
+
+  void reset()
+  {
+    histogram_.reset();
+    numPending_ = 0;
+    dropped_ = 0;
+    current_.stages = 0;
+    last_.stages = 0;
+  }
+
+private:
+  LatencyTracer() :
+    numPending_(0),
+    dropped_(0)
+  {
+    current_.stages = 0;
+    last_.stages = 0;
+  }
+
+  LatencyHistogram histogram_;
+  Trace current_;
+  Trace last_;
+  Trace pending_[UWDG_LATENCY_PENDING];
+  uint8_t numPending_;
+  uint32_t dropped_;
+};
+
+} // namespace uwdg
+
+#endif // UWDG_LATENCY_H
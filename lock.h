@@ -0,0 +1,73 @@
+#ifndef UWDG_LOCK_H
+#define UWDG_LOCK_H
+
+#include <gfx.h>
+
+namespace uwdg
+{
+
+/* Protects state that is shared by the render passes of different displays,
+  which may run in different threads given GDISP_NEED_MULTITHREAD (see
+  RenderContext). Without it, locking compiles to nothing.
+*/
+class Mutex
+{
+public:
+#if GDISP_NEED_MULTITHREAD
+  Mutex()
+  {
+    gfxMutexInit(&mutex_);
+  }
+
+  ~Mutex()
+  {
+    gfxMutexDestroy(&mutex_);
+  }
+
+  void lock()
+  {
+    gfxMutexEnter(&mutex_);
+  }
+
+  void unlock()
+  {
+    gfxMutexExit(&mutex_);
+  }
+#else
+  Mutex() {}
+  void lock() {}
+  void unlock() {}
+#endif // GDISP_NEED_MULTITHREAD
+
+private:
+  Mutex(const Mutex&);
+  Mutex& operator=(const Mutex&);
+#if GDISP_NEED_MULTITHREAD
+  gfxMutex mutex_;
+#endif // GDISP_NEED_MULTITHREAD
+};
+
+// holds a Mutex for its scope
+class Lock
+{
+public:
+  explicit Lock(Mutex& m) :
+    mutex_(m)
+  {
+    mutex_.lock();
+  }
+
+  ~Lock()
+  {
+    mutex_.unlock();
+  }
+
+private:
+  Lock(const Lock&);
+  Lock& operator=(const Lock&);
+  Mutex& mutex_;
+};
+
+} // namespace uwdg
+
+#endif // UWDG_LOCK_H
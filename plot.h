@@ -0,0 +1,298 @@
+#ifndef UWDG_PLOT_H
+#define UWDG_PLOT_H
+
+#include "widget.h"
+
+namespace uwdg
+{
+
+/* Strip chart of a stream of samples.
+
+  Samples are condensed into columns of one pixel each: every column covers
+  samplesPerColumn() samples and keeps their minimum and maximum (plus the
+  last value of the previous column, so the trace stays connected). Columns
+  go into a ring buffer, which must be provided by the user; StaticPlot<N>
+  does that.
+
+  New columns are painted incrementally with update()/drawUpdate(), so adding
+  a sample never repaints the whole chart:
+  - eSweep: time runs left to right and wraps around like on an oscilloscope,
+    a small gap in front of the newest column is cleared.
+  - eScroll: time runs top to bottom and the chart scrolls up by one line per
+    column with gdispGVerticalScroll() (needs GDISP_NEED_SCROLL). ugfx has no
+    horizontal area copy, so scrolling is only available in this orientation.
+    A partly clipped chart can't scroll and is redrawn.
+
+  addSample() is O(1) and doesn't draw, but it must not run concurrently with
+  a draw pass.
+*/
+class Plot : public Widget
+{
+public:
+  typedef int16_t Sample;
+  struct Column
+  {
+    Sample min;
+    Sample max;
+  };
+
+  enum Mode
+  {
+    eSweep,
+    eScroll
+  };
+
+  Plot(Column* buffer, uint16_t capacity, Widget* parent = nullptr) :
+    Widget(parent),
+    columns_(buffer),
+    capacity_(capacity),
+    mode_(eSweep),
+    min_(-32768),
+    max_(32767),
+    samplesPerColumn_(1),
+    inColumn_(0),
+    total_(0),
+    drawn_(0),
+    hasLast_(false)
+  {
+  }
+
+  virtual uint8_t classId() const override
+  {
+    return eClassOther;
+  }
+
+  /*****************************************************************************
+  * Configuration
+  *****************************************************************************/
+  void setMode(Mode m)
+  {
+    mode_ = m;
+    redraw();
+  }
+
+  Mode mode() const
+  {
+    return mode_;
+  }
+
+  void setRange(Sample min, Sample max)
+  {
+    min_ = min;
+    max_ = max > min ? max : min + 1;
+    redraw();
+  }
+
+  // decimation: number of samples condensed into one pixel column
+  void setSamplesPerColumn(uint16_t n)
+  {
+    n = n != 0 ? n : 1;
+    if(n != samplesPerColumn_)
+    {
+      samplesPerColumn_ = n;
+      inColumn_ = 0;
+      redraw();
+    }
+  }
+
+  uint16_t samplesPerColumn() const
+  {
+    return samplesPerColumn_;
+  }
+
+  /*****************************************************************************
+  * Data
+  *****************************************************************************/
+  void addSample(Sample s)
+  {
+    if(inColumn_ == 0)
+    {
+      current_.min = hasLast_ ? last_ : s;
+      current_.max = current_.min;
+    }
+    current_.min = s < current_.min ? s : current_.min;
+    current_.max = s > current_.max ? s : current_.max;
+    last_ = s;
+    hasLast_ = true;
+    if(++inColumn_ == samplesPerColumn_)
+    {
+      inColumn_ = 0;
+      columns_[total_ % capacity_] = current_;
+      total_++;
+      update();
+    }
+  }
+
+  void addSamples(const Sample* s, uint16_t n)
+  {
+    for(uint16_t i = 0; i < n; i++)
+    {
+      addSample(s[i]);
+    }
+  }
+
+  void clear()
+  {
+    total_ = 0;
+    drawn_ = 0;
+    inColumn_ = 0;
+    hasLast_ = false;
+    redraw();
+  }
+
+  /*****************************************************************************
+  * Drawing
+  *****************************************************************************/
+  virtual void draw(RenderContext& rc) const override
+  {
+    Widget::draw(rc);
+    uint32_t n = visibleColumns();
+    n = total_ < n ? total_ : n;
+    for(uint32_t k = total_ - n; k != total_; k++)
+    {
+      drawColumn(rc, k, false);
+    }
+    drawn_ = total_;
+  }
+
+  virtual bool drawUpdate(RenderContext& rc) override
+  {
+    uint32_t n = total_ - drawn_;
+    if((n == 0) || (n > visibleColumns()))
+    {
+      return (n == 0);
+    }
+    if(mode_ == eScroll)
+    {
+#if GDISP_NEED_SCROLL
+      if(!rc.verticalScroll(1, 1, innerWidth(), innerHeight(), n, colorSet().fill))
+      {
+        return false;
+      }
+#else
+      return false;
+#endif // GDISP_NEED_SCROLL
+    }
+    for(uint32_t k = drawn_; k != total_; k++)
+    {
+      drawColumn(rc, k, true);
+    }
+    drawn_ = total_;
+    return true;
+  }
+
+private:
+  static constexpr Length sweepGap = 4;
+
+  Length innerWidth() const
+  {
+    return width() > 2 ? width() - 2 : 0;
+  }
+
+  Length innerHeight() const
+  {
+    return height() > 2 ? height() - 2 : 0;
+  }
+
+  // length of the time axis in pixels
+  Length timeLength() const
+  {
+    return mode_ == eSweep ? innerWidth() : innerHeight();
+  }
+
+  // number of the most recent columns that are on screen
+  uint32_t visibleColumns() const
+  {
+    Length l = timeLength();
+    if(mode_ == eSweep)
+    {
+      l = l > sweepGap ? l - sweepGap : 0;
+    }
+    return l < capacity_ ? l : capacity_;
+  }
+
+  // pixel position of v along the value axis
+  Coordinate scale(Sample v, Length l) const
+  {
+    if(v <= min_)
+    {
+      return 0;
+    }
+    if(v >= max_)
+    {
+      return l - 1;
+    }
+    return (static_cast<int32_t>(v - min_) * (l - 1)) / (max_ - min_);
+  }
+
+  void drawColumn(RenderContext& rc, uint32_t k, bool erase) const
+  {
+    const Column& c = columns_[k % capacity_];
+    const Color fill = colorSet().fill;
+    const Color trace = colorSet().text;
+    if(mode_ == eSweep)
+    {
+      const Length w = innerWidth();
+      const Length h = innerHeight();
+      if((w == 0) || (h == 0))
+      {
+        return;
+      }
+      Coordinate x = 1 + (k % w);
+      if(erase)
+      {
+        // clear this column and the gap in front of it
+        for(Length i = 0; i <= sweepGap; i++)
+        {
+          rc.fillArea(1 + ((k + i) % w), 1, 1, h, fill);
+        }
+      }
+      Coordinate top = h - scale(c.max, h);
+      Coordinate bottom = h - scale(c.min, h);
+      rc.fillArea(x, top, 1, bottom - top + 1, trace);
+    }
+    else
+    {
+      const Length w = innerWidth();
+      const Length h = innerHeight();
+      if((w == 0) || (h == 0))
+      {
+        return;
+      }
+      // the newest row is at the bottom
+      Coordinate y = 1 + h - (total_ - k);
+      Coordinate left = 1 + scale(c.min, w);
+      Coordinate right = 1 + scale(c.max, w);
+      rc.fillArea(left, y, right - left + 1, 1, trace);
+    }
+  }
+
+  Column* columns_;
+  uint16_t capacity_;
+  Mode mode_;
+  Sample min_;
+  Sample max_;
+  uint16_t samplesPerColumn_;
+  uint16_t inColumn_;
+  Column current_;
+  Sample last_;
+  uint32_t total_;         // columns completed so far
+  // columns on screen up to here. draw() is const like for every widget, but
+  // drawUpdate() continues from what the last full draw painted, so it's
+  // recorded there (as drawnAngle_ in Gauge and drawnEdge_ in ProgressBar)
+  mutable uint32_t drawn_;
+  bool hasLast_;
+};
+
+template <uint16_t N>
+class StaticPlot : public Plot
+{
+public:
+  StaticPlot(Widget* parent = nullptr) : Plot(buffer_, N, parent) {}
+private:
+  Column buffer_[N];
+};
+
+} // namespace uwdg
+
+#endif // UWDG_PLOT_H
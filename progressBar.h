@@ -0,0 +1,102 @@
+#ifndef UWDG_PROGRESSBAR_H
+#define UWDG_PROGRESSBAR_H
+
+#include "valueWidget.h"
+
+namespace uwdg
+{
+
+/* Bar filled from the left (or bottom) in proportion to its value.
+
+  Value changes only paint the span between the previously drawn fill edge
+  and the new one.
+*/
+class ProgressBar : public ValueWidget
+{
+public:
+  enum Orientation
+  {
+    eHorizontal,
+    eVertical
+  };
+
+  ProgressBar(Widget* parent = nullptr) :
+    ValueWidget(parent),
+    orientation_(eHorizontal),
+    drawnEdge_(0)
+  {
+  }
+
+  Orientation orientation() const
+  {
+    return orientation_;
+  }
+
+  void setOrientation(Orientation o)
+  {
+    if(o != orientation_)
+    {
+      orientation_ = o;
+      redraw();
+    }
+  }
+
+  virtual void draw(RenderContext& rc) const override
+  {
+    Widget::draw(rc);
+    drawnEdge_ = 0;
+    paint(rc, edge());
+  }
+
+  virtual bool drawUpdate(RenderContext& rc) override
+  {
+    paint(rc, edge());
+    return true;
+  }
+
+private:
+  Length length() const
+  {
+    Length l = orientation_ == eHorizontal ? width() : height();
+    return l > 2 ? l - 2 : 0;
+  }
+
+  Length thickness() const
+  {
+    Length t = orientation_ == eHorizontal ? height() : width();
+    return t > 2 ? t - 2 : 0;
+  }
+
+  Length edge() const
+  {
+    return scale(value(), length());
+  }
+
+  // fills the inner area from 0 to e, painting only what differs from drawnEdge_
+  void paint(RenderContext& rc, Length e) const
+  {
+    if(e == drawnEdge_)
+    {
+      return;
+    }
+    Length from = e < drawnEdge_ ? e : drawnEdge_;
+    Length span = e < drawnEdge_ ? drawnEdge_ - e : e - drawnEdge_;
+    Color c = e > drawnEdge_ ? colorSet().text : colorSet().fill;
+    if(orientation_ == eHorizontal)
+    {
+      rc.fillArea(1 + from, 1, span, thickness(), c);
+    }
+    else
+    {
+      rc.fillArea(1, 1 + length() - from - span, thickness(), span, c);
+    }
+    drawnEdge_ = e;
+  }
+
+  Orientation orientation_;
+  mutable Length drawnEdge_;
+};
+
+} // namespace uwdg
+
+#endif // UWDG_PROGRESSBAR_H
@@ -0,0 +1,405 @@
+#ifndef UWDG_RENDERCONTEXT_H
+#define UWDG_RENDERCONTEXT_H
+
+#include "drawList.h"
+#include "geometry.h"
+#include "style.h"
+
+namespace uwdg
+{
+
+/* State of one render pass: the target display, the offset of the widget
+  that is currently being drawn and the clipping rectangle that applies to it.
+
+  A context is created per pass by Widget::drawWidgets() and handed down the
+  draw path, so roots on different displays can be drawn independently (and
+  from different threads, given GDISP_NEED_MULTITHREAD) without sharing any
+  static drawing state.
+
+  The clip is applied to the display lazily: entering and leaving scopes only
+  changes the requested clip, and the drawing functions below push it to the
+  display when a primitive would actually be affected by the difference.
+  Code that calls gdisp directly must call applyClip() first.
+
+  When constructed with a DrawList, the drawing functions record into that
+  list instead of drawing (see drawList.h).
+
+  Cached pixmaps that are drawn are pinned with pins() until the context is
+  destroyed, or the list it records into is cleared.
+*/
+class RenderContext
+{
+public:
+  explicit RenderContext(GDisplay* g, DrawList* list = nullptr) :
+    display_(g),
+    clip_(Point(0, 0), Size(gdispGGetWidth(g), gdispGGetHeight(g))),
+    appliedValid_(false),
+    clipChanges_(0),
+    primitives_(0),
+    list_(list)
+  {
+  }
+
+  bool recording() const
+  {
+    return list_ != nullptr;
+  }
+
+  CachePins& pins()
+  {
+    return recording() ? list_->pins() : pins_;
+  }
+
+  /* Draws what has been recorded so far (see DrawList::flush()) and releases
+    the cache entries pinned up to here, as nothing refers to them any more.
+    Drawing directly, everything is drawn already and only the pins go.
+  */
+  void flush()
+  {
+    if(recording())
+    {
+      list_->flush(display_);
+    }
+    else
+    {
+      pins_.release();
+    }
+  }
+
+  GDisplay* display() const
+  {
+    return display_;
+  }
+
+  const Point& offset() const
+  {
+    return offset_;
+  }
+
+  const Rectangle& clip() const
+  {
+    return clip_;
+  }
+
+  bool clipEmpty() const
+  {
+    return clip_.empty();
+  }
+
+  // cost of a pass, returned by Widget::drawWidgets()
+  struct Stats
+  {
+    uint32_t clipChanges;
+    uint32_t primitives;
+  };
+
+  Stats stats() const
+  {
+    Stats s = {clipChanges_, primitives_};
+    return s;
+  }
+
+  // number of gdispGSetClip() calls issued by this context so far
+  uint32_t clipChanges() const
+  {
+    return clipChanges_;
+  }
+
+  // number of primitives drawn or recorded so far
+  uint32_t primitives() const
+  {
+    return primitives_;
+  }
+
+  // bounding box of what was drawn or recorded so far (absolute, clipped)
+  const Rectangle& drawnBounds() const
+  {
+    return drawn_;
+  }
+
+  Coordinate absX(const Coordinate& x) const
+  {
+    return x + offset_.x;
+  }
+  Coordinate absX(const Point& p) const
+  {
+    return absX(p.x);
+  }
+  Coordinate absY(const Coordinate& y) const
+  {
+    return y + offset_.y;
+  }
+  Coordinate absY(const Point& p) const
+  {
+    return absY(p.y);
+  }
+  Point absPoint(const Point& p) const
+  {
+    return p + offset_;
+  }
+  Point absPoint(const Coordinate& x, const Coordinate& y) const
+  {
+    return absPoint(Point(x,y));
+  }
+
+  /* One level of the offset/clip stack. Entering a scope moves the origin to
+    the given rectangle (relative to the current origin) and narrows the clip
+    to it, leaving the scope restores both. Scopes live on the call stack, so
+    the stack depth follows the widget tree depth without a fixed limit.
+  */
+  class Scope
+  {
+  public:
+    Scope(RenderContext& rc, const Rectangle& r) :
+      rc_(rc),
+      offset_(rc.offset_),
+      clip_(rc.clip_)
+    {
+      rc_.offset_ += r.p0;
+      rc_.clip_ &= Rectangle(rc_.offset_, r.size);
+    }
+
+    ~Scope()
+    {
+      rc_.offset_ = offset_;
+      rc_.clip_ = clip_;
+    }
+
+  private:
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+    RenderContext& rc_;
+    const Point offset_;
+    const Rectangle clip_;
+  };
+
+  /* Narrows the clip to a rectangle relative to the current origin until the
+    scope is left, without moving the origin.
+  */
+  class ClipScope
+  {
+  public:
+    ClipScope(RenderContext& rc, const Rectangle& r) :
+      rc_(rc),
+      clip_(rc.clip_)
+    {
+      rc_.clip_ &= Rectangle(rc_.absPoint(r.p0), r.size);
+    }
+
+    ~ClipScope()
+    {
+      rc_.clip_ = clip_;
+    }
+
+  private:
+    ClipScope(const ClipScope&);
+    ClipScope& operator=(const ClipScope&);
+    RenderContext& rc_;
+    const Rectangle clip_;
+  };
+
+  /*****************************************************************************
+  * drawing, coordinates relative to the current origin
+  *****************************************************************************/
+  void fillArea(Coordinate x, Coordinate y, Length cx, Length cy, Color color)
+  {
+    if(recording())
+    {
+      record(DrawList::Command::eFill, x, y, cx, cy, color);
+    }
+    else if(prepare(x, y, cx, cy))
+    {
+      gdispGFillArea(display_, absX(x), absY(y), cx, cy, color);
+    }
+  }
+
+  void drawBox(Coordinate x, Coordinate y, Length cx, Length cy, Color color)
+  {
+    if(recording())
+    {
+      record(DrawList::Command::eBox, x, y, cx, cy, color);
+    }
+    else if(prepare(x, y, cx, cy))
+    {
+      gdispGDrawBox(display_, absX(x), absY(y), cx, cy, color);
+    }
+  }
+
+  void drawStringBox(Coordinate x, Coordinate y, Length cx, Length cy,
+                     const char* str, Font font, Color color, justify_t justify)
+  {
+    if(recording())
+    {
+      record(DrawList::Command::eString, x, y, cx, cy, color, str, font, justify);
+    }
+    else if(prepare(x, y, cx, cy))
+    {
+      gdispGDrawStringBox(display_, absX(x), absY(y), cx, cy,
+                          str, font, color, justify);
+    }
+  }
+
+  void drawLine(Coordinate x0, Coordinate y0, Coordinate x1, Coordinate y1,
+                Color color)
+  {
+    Coordinate left = x0 < x1 ? x0 : x1;
+    Coordinate top = y0 < y1 ? y0 : y1;
+    Length cx = (x0 < x1 ? x1 - x0 : x0 - x1) + 1;
+    Length cy = (y0 < y1 ? y1 - y0 : y0 - y1) + 1;
+    if(recording())
+    {
+      DrawList::Command* c = record(DrawList::Command::eLine, left, top, cx, cy, color);
+      if(c != nullptr)
+      {
+        c->x0 = absX(x0);
+        c->y0 = absY(y0);
+        c->x1 = absX(x1);
+        c->y1 = absY(y1);
+      }
+    }
+    else if(prepare(left, top, cx, cy))
+    {
+      gdispGDrawLine(display_, absX(x0), absY(y0), absX(x1), absY(y1), color);
+    }
+  }
+
+#if GDISP_NEED_ARC
+  // pie sector around (x, y), angles in degrees counter-clockwise from 3 o'clock
+  void fillArc(Coordinate x, Coordinate y, Length radius,
+               Coordinate startAngle, Coordinate endAngle, Color color)
+  {
+    if(recording())
+    {
+      DrawList::Command* c = record(DrawList::Command::eFillArc, x - radius, y - radius,
+                                    2 * radius + 1, 2 * radius + 1, color);
+      if(c != nullptr)
+      {
+        c->x0 = absX(x);
+        c->y0 = absY(y);
+        c->x1 = startAngle;
+        c->y1 = endAngle;
+      }
+    }
+    else if(prepare(x - radius, y - radius, 2 * radius + 1, 2 * radius + 1))
+    {
+      gdispGFillArc(display_, absX(x), absY(y), radius, startAngle, endAngle, color);
+    }
+  }
+#endif // GDISP_NEED_ARC
+
+  // copies cx * cy pixels from (srcx, srcy) of a bitmap with lines of srccx pixels
+  void blitArea(Coordinate x, Coordinate y, Length cx, Length cy,
+                Coordinate srcx, Coordinate srcy, Length srccx, const pixel_t* bits)
+  {
+    if(recording())
+    {
+      DrawList::Command* c = record(DrawList::Command::eBlit, x, y, cx, cy, 0);
+      if(c != nullptr)
+      {
+        c->bits = bits;
+        c->x0 = srcx;
+        c->y0 = srcy;
+        c->x1 = srccx;
+      }
+    }
+    else if(prepare(x, y, cx, cy))
+    {
+      gdispGBlitArea(display_, absX(x), absY(y), cx, cy, srcx, srcy, srccx, bits);
+    }
+  }
+
+#if GDISP_NEED_SCROLL
+  /* Returns false if the area can't be scrolled: while recording, or if the
+    clip doesn't contain all of it, as the lines that scroll in from a clipped
+    edge would have to be drawn. The caller then draws the area completely.
+  */
+  bool verticalScroll(Coordinate x, Coordinate y, Length cx, Length cy,
+                      int lines, Color background)
+  {
+    if(recording() || !clip_.contains(Rectangle(absPoint(x, y), Size(cx, cy))))
+    {
+      return false;
+    }
+    if(prepare(x, y, cx, cy))
+    {
+      gdispGVerticalScroll(display_, absX(x), absY(y), cx, cy, lines, background);
+    }
+    return true;
+  }
+#endif // GDISP_NEED_SCROLL
+
+  // make the display clip match the requested one right away
+  void applyClip()
+  {
+    if(!appliedValid_ || (applied_ != clip_))
+    {
+      gdispGSetClip(display_, clip_.p0.x, clip_.p0.y, clip_.size.w, clip_.size.h);
+      applied_ = clip_;
+      appliedValid_ = true;
+      clipChanges_++;
+    }
+  }
+
+private:
+  /* Makes sure that drawing into the given area (relative) produces the same
+    pixels as with the requested clip. Returns false if nothing would be
+    visible at all. A primitive that lies inside both the requested and the
+    applied clip is not affected by either, so the display clip is left alone.
+  */
+  bool prepare(Coordinate x, Coordinate y, Length cx, Length cy)
+  {
+    Rectangle area(absPoint(x, y), Size(cx, cy));
+    Rectangle visible = area & clip_;
+    if(visible.empty())
+    {
+      return false;
+    }
+    primitives_++;
+    drawn_ |= visible;
+    if(appliedValid_ && (visible == area) && applied_.contains(area))
+    {
+      return true;
+    }
+    applyClip();
+    return true;
+  }
+
+  // returns the recorded command, or nullptr if it was clipped away
+  DrawList::Command* record(uint8_t type, Coordinate x, Coordinate y,
+                            Length cx, Length cy, Color color,
+                            const char* text = nullptr, Font font = DefaultFont,
+                            justify_t justify = justifyLeft)
+  {
+    DrawList::Command c;
+    c.type = type;
+    c.justify = justify;
+    c.color = color;
+    c.area = Rectangle(absPoint(x, y), Size(cx, cy));
+    c.clip = clip_;
+    c.text = text;
+    c.font = font;
+    c.x0 = c.y0 = c.x1 = c.y1 = 0;
+    if((c.area & c.clip).empty())
+    {
+      return nullptr;
+    }
+    primitives_++;
+    drawn_ |= c.area & c.clip;
+    return list_->add(display_, c);
+  }
+
+  GDisplay* display_;
+  Point offset_;
+  Rectangle clip_;
+  Rectangle applied_;
+  bool appliedValid_;
+  uint32_t clipChanges_;
+  uint32_t primitives_;
+  Rectangle drawn_;
+  DrawList* list_;
+  CachePins pins_;
+};
+
+} // namespace uwdg
+
+#endif // UWDG_RENDERCONTEXT_H
@@ -0,0 +1,439 @@
+#ifndef UWDG_SCREEN_H
+#define UWDG_SCREEN_H
+
+#include <new>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <typeinfo>
+
+#include "button.h"
+#include "label.h"
+#include "widget.h"
+
+namespace uwdg
+{
+
+/* Binary screen descriptions.
+
+  A screen image describes a widget tree so that screens can live in flash
+  and be instantiated in one pass instead of being built with constructor
+  calls. All numbers are little endian and read byte by byte, so an image can
+  be used in place from memory-mapped flash at any alignment.
+
+    header   "UWS1", uint16 node count, uint16 string count
+    nodes    node count * 16 bytes, in pre-order (parents before children):
+             uint8  class (Widget::EClass)
+             uint8  flags (ScreenFormat::eVisible etc.)
+             uint8  StyleTable index, 0xFF: inherit
+             uint8  alignment (Label::Alignment)
+             int16  x, y (relative to the parent)
+             uint16 width, height
+             uint16 parent node index, 0xFFFF for the root
+             uint16 string index, 0xFFFF for none
+    strings  string count * uint16 offset from the start of the image,
+             followed by the zero-terminated strings
+
+  Only Widget, Label and Button are supported, not classes derived from
+  them, which would be loaded as their base class. ScreenWriter produces
+  images from trees built with the normal API (on the host), Screen
+  instantiates them.
+*/
+struct ScreenFormat
+{
+  static constexpr size_t headerSize = 8;
+  static constexpr size_t nodeSize = 16;
+  static constexpr uint16_t none = 0xFFFF;
+  static constexpr uint8_t inheritStyle = StyleTable::inherit;
+
+  enum EFlags
+  {
+    eVisible = (1<<0),
+    eTransparent = (1<<1),
+    eAcceptsFocus = (1<<2)
+  };
+
+  static uint16_t read16(const uint8_t* p)
+  {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+  }
+
+  static void write16(uint8_t* p, uint16_t v)
+  {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+  }
+};
+
+/* Widget tree instantiated from a screen image into a user-provided pool.
+
+  The pool must be suitably aligned and at least poolSize(image) bytes large.
+  The image is read in place, not copied, and only needs to be accessible
+  while loading; texts are copied into the labels. The tree is destroyed
+  (children first) by unload() or the destructor.
+*/
+class Screen
+{
+public:
+  Screen() :
+    widgets_(nullptr),
+    count_(0)
+  {
+  }
+
+  ~Screen()
+  {
+    unload();
+  }
+
+  // bytes of pool needed for image, 0 if the image is invalid
+  static size_t poolSize(const uint8_t* image, size_t size)
+  {
+    if(!validHeader(image, size))
+    {
+      return 0;
+    }
+    const uint16_t n = ScreenFormat::read16(image + 4);
+    size_t bytes = n * sizeof(Widget*);
+    for(uint16_t i = 0; i < n; i++)
+    {
+      size_t s = objectSize(node(image, i)[0]);
+      if(s == 0)
+      {
+        return 0;
+      }
+      bytes = align(bytes) + s;
+    }
+    return bytes;
+  }
+
+  /* Instantiates image in pool. Style indices refer to the StyleTable, which
+    must have been set up the same way as when the image was written. Returns the root widget, or nullptr if the image is invalid or the pool is
+    too small.
+  */
+  Widget* load(const uint8_t* image, size_t size, void* pool, size_t poolBytes)
+  {
+    unload();
+    size_t needed = poolSize(image, size);
+    if((needed == 0) || (needed > poolBytes))
+    {
+      return nullptr;
+    }
+    const uint16_t n = ScreenFormat::read16(image + 4);
+    const uint16_t strings = ScreenFormat::read16(image + 6);
+    uint8_t* mem = static_cast<uint8_t*>(pool);
+    widgets_ = reinterpret_cast<Widget**>(mem);
+    size_t used = n * sizeof(Widget*);
+    for(uint16_t i = 0; i < n; i++)
+    {
+      const uint8_t* p = node(image, i);
+      const uint16_t parentIndex = ScreenFormat::read16(p + 12);
+      const uint16_t textIndex = ScreenFormat::read16(p + 14);
+      Widget* parent = nullptr;
+      if(parentIndex != ScreenFormat::none)
+      {
+        if(parentIndex >= i)
+        {
+          unload();
+          return nullptr; // parents must come first
+        }
+        parent = widgets_[parentIndex];
+      }
+      else if(i != 0)
+      {
+        unload();
+        return nullptr; // only one root
+      }
+      const char* text = "";
+      if(textIndex != ScreenFormat::none)
+      {
+        text = string(image, size, strings, textIndex);
+        if(text == nullptr)
+        {
+          unload();
+          return nullptr;
+        }
+      }
+      used = align(used);
+      widgets_[i] = create(p[0], mem + used, parent, text);
+      used += objectSize(p[0]);
+      count_ = i + 1;
+      setup(widgets_[i], p);
+    }
+    return count_ != 0 ? widgets_[0] : nullptr;
+  }
+
+  void unload()
+  {
+    while(count_ != 0)
+    {
+      count_--;
+      widgets_[count_]->~Widget();
+    }
+    widgets_ = nullptr;
+  }
+
+  Widget* root() const
+  {
+    return count_ != 0 ? widgets_[0] : nullptr;
+  }
+
+  // widget by node index
+  Widget* widget(uint16_t i) const
+  {
+    return i < count_ ? widgets_[i] : nullptr;
+  }
+
+  uint16_t count() const
+  {
+    return count_;
+  }
+
+private:
+  Screen(const Screen&);
+  Screen& operator=(const Screen&);
+
+  static size_t align(size_t n)
+  {
+    const size_t a = alignof(Button) > alignof(Widget*) ? alignof(Button) : alignof(Widget*);
+    return (n + a - 1) & ~(a - 1);
+  }
+
+  static bool validHeader(const uint8_t* image, size_t size)
+  {
+    if((image == nullptr) || (size < ScreenFormat::headerSize) ||
+       (image[0] != 'U') || (image[1] != 'W') || (image[2] != 'S') || (image[3] != '1'))
+    {
+      return false;
+    }
+    const size_t n = ScreenFormat::read16(image + 4);
+    const size_t strings = ScreenFormat::read16(image + 6);
+    return ScreenFormat::headerSize + n * ScreenFormat::nodeSize + 2 * strings <= size;
+  }
+
+  static const uint8_t* node(const uint8_t* image, uint16_t i)
+  {
+    return image + ScreenFormat::headerSize + i * ScreenFormat::nodeSize;
+  }
+
+  static const char* string(const uint8_t* image, size_t size, uint16_t count, uint16_t i)
+  {
+    if(i >= count)
+    {
+      return nullptr;
+    }
+    const uint16_t n = ScreenFormat::read16(image + 4);
+    const uint8_t* table = node(image, n);
+    size_t offset = ScreenFormat::read16(table + 2 * i);
+    // must be terminated within the image
+    for(size_t k = offset; k < size; k++)
+    {
+      if(image[k] == 0)
+      {
+        return reinterpret_cast<const char*>(image + offset);
+      }
+    }
+    return nullptr;
+  }
+
+  static size_t objectSize(uint8_t classId)
+  {
+    switch(classId)
+    {
+      case Widget::eClassWidget:
+        return sizeof(Widget);
+      case Widget::eClassLabel:
+        return sizeof(Label);
+      case Widget::eClassButton:
+        return sizeof(Button);
+      default:
+        return 0;
+    }
+  }
+
+  static Widget* create(uint8_t classId, void* mem, Widget* parent, const char* text)
+  {
+    switch(classId)
+    {
+      case Widget::eClassLabel:
+        return new (mem) Label(text, parent);
+      case Widget::eClassButton:
+        return new (mem) Button(text, parent);
+      default:
+        return new (mem) Widget(parent);
+    }
+  }
+
+  static void setup(Widget* w, const uint8_t* p)
+  {
+    const uint8_t flags = p[1];
+    if((p[2] != ScreenFormat::inheritStyle) && (p[2] < StyleTable::count()))
+    {
+      w->setStyle(p[2]);
+    }
+    if((p[0] == Widget::eClassLabel) || (p[0] == Widget::eClassButton))
+    {
+      static_cast<Label*>(w)->setAlignment(static_cast<Label::Alignment>(p[3]));
+    }
+    const Coordinate x = static_cast<int16_t>(ScreenFormat::read16(p + 4));
+    const Coordinate y = static_cast<int16_t>(ScreenFormat::read16(p + 6));
+    const Length width = ScreenFormat::read16(p + 8);
+    const Length height = ScreenFormat::read16(p + 10);
+    if(w->hasParent())
+    {
+      w->moveTo(Point(x, y));
+      w->setSize(width, height);
+    }
+    w->setVisible(flags & ScreenFormat::eVisible);
+    w->setTransparent(flags & ScreenFormat::eTransparent);
+    w->setAcceptsFocus(flags & ScreenFormat::eAcceptsFocus);
+  }
+
+  Widget** widgets_;
+  uint16_t count_;
+};
+
+#if defined(__cpp_rtti) || defined(__GXX_RTTI)
+/* Serializes a widget tree into a screen image (host side). Widgets of
+  unsupported classes make write() fail. A class is supported only if the
+  widget's exact type is the one Screen creates for its classId(), so derived
+  classes that inherit a supported classId() are rejected. Needs RTTI.
+*/
+class ScreenWriter
+{
+public:
+  // returns the image size, or 0 if out is too small or the tree is unsupported
+  size_t write(const Widget& root, uint8_t* out, size_t capacity) const
+  {
+    uint16_t nodes = 0;
+    uint16_t strings = 0;
+    size_t textBytes = 0;
+    if(!count(root, nodes, strings, textBytes))
+    {
+      return 0;
+    }
+    const size_t stringTable = ScreenFormat::headerSize + nodes * ScreenFormat::nodeSize;
+    const size_t size = stringTable + 2 * strings + textBytes;
+    if((size > capacity) || (size > 0xFFFF))
+    {
+      return 0;
+    }
+    out[0] = 'U';
+    out[1] = 'W';
+    out[2] = 'S';
+    out[3] = '1';
+    ScreenFormat::write16(out + 4, nodes);
+    ScreenFormat::write16(out + 6, strings);
+    State s = {out, stringTable, stringTable + 2 * strings, 0, 0};
+    writeNode(root, ScreenFormat::none, s);
+    return size;
+  }
+
+  // writes image as a C array definition, e.g. to compile it into flash
+  static bool writeCArray(FILE* f, const char* name, const uint8_t* image, size_t size)
+  {
+    if(fprintf(f, "const uint8_t %s[%u] = {", name, (unsigned)size) < 0)
+    {
+      return false;
+    }
+    for(size_t i = 0; i < size; i++)
+    {
+      fprintf(f, "%s0x%02X", (i % 12 == 0) ? "\n  " : " ", image[i]);
+      if(i + 1 < size)
+      {
+        fputc(',', f);
+      }
+    }
+    return fprintf(f, "\n};\n") >= 0;
+  }
+
+private:
+  struct State
+  {
+    uint8_t* out;
+    size_t stringTable;
+    size_t textOffset;
+    uint16_t node;
+    uint16_t string;
+  };
+
+  static bool hasText(const Widget& w)
+  {
+    return (w.classId() == Widget::eClassLabel) || (w.classId() == Widget::eClassButton);
+  }
+
+  // true if Screen would create w's exact class from its classId()
+  static bool supported(const Widget& w)
+  {
+    switch(w.classId())
+    {
+      case Widget::eClassWidget:
+        return typeid(w) == typeid(Widget);
+      case Widget::eClassLabel:
+        return typeid(w) == typeid(Label);
+      case Widget::eClassButton:
+        return typeid(w) == typeid(Button);
+      default:
+        return false;
+    }
+  }
+
+  bool count(const Widget& w, uint16_t& nodes, uint16_t& strings, size_t& textBytes) const
+  {
+    if(!supported(w))
+    {
+      return false;
+    }
+    nodes++;
+    if(hasText(w))
+    {
+      strings++;
+      textBytes += strlen(static_cast<const Label&>(w).text()) + 1;
+    }
+    for(const Widget* c = w.children(); c != nullptr; c = c->next())
+    {
+      if(!count(*c, nodes, strings, textBytes))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void writeNode(const Widget& w, uint16_t parent, State& s) const
+  {
+    const uint16_t index = s.node++;
+    uint8_t* p = s.out + ScreenFormat::headerSize + index * ScreenFormat::nodeSize;
+    p[0] = w.classId();
+    p[1] = (w.getFlag(Widget::flag_visible) ? ScreenFormat::eVisible : 0) |
+           (w.transparent() ? ScreenFormat::eTransparent : 0) |
+           (w.getFlag(Widget::flag_acceptsFocus) ? ScreenFormat::eAcceptsFocus : 0);
+    p[2] = w.styleIndex();
+    p[3] = hasText(w) ? static_cast<const Label&>(w).alignment() : 0;
+    ScreenFormat::write16(p + 4, w.position().x);
+    ScreenFormat::write16(p + 6, w.position().y);
+    ScreenFormat::write16(p + 8, w.width());
+    ScreenFormat::write16(p + 10, w.height());
+    ScreenFormat::write16(p + 12, parent);
+    ScreenFormat::write16(p + 14, ScreenFormat::none);
+    if(hasText(w))
+    {
+      const char* text = static_cast<const Label&>(w).text();
+      const size_t len = strlen(text) + 1;
+      ScreenFormat::write16(p + 14, s.string);
+      ScreenFormat::write16(s.out + s.stringTable + 2 * s.string, s.textOffset);
+      memcpy(s.out + s.textOffset, text, len);
+      s.textOffset += len;
+      s.string++;
+    }
+    for(const Widget* c = w.children(); c != nullptr; c = c->next())
+    {
+      writeNode(*c, index, s);
+    }
+  }
+};
+#endif // __cpp_rtti || __GXX_RTTI
+
+} // namespace uwdg
+
+#endif // UWDG_SCREEN_H
@@ -0,0 +1,283 @@
+#ifndef UWDG_SNAPSHOT_H
+#define UWDG_SNAPSHOT_H
+
+/* Host-side tooling for checking rendering results.
+
+  Scenes are rendered into a display that can be read back, e.g. a pixmap
+  (GDISP_NEED_PIXMAP) that a root widget is moved to with setDisplay(). A
+  Snapshot then saves the display as binary PPM or compares it against a
+  reference PPM, writing an image that highlights the differing pixels.
+
+  OverdrawMap counts how often each pixel is written by the primitives in a
+  DrawList (record a frame with Widget::recordWidgets()) and saves the counts
+  as a heatmap. Strings count their whole (clipped) text box and lines and
+  arcs their bounding box, since the exact pixels aren't known at that level.
+
+  Everything here uses stdio and is meant for hosts, not for targets.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "drawList.h"
+#include "geometry.h"
+
+namespace uwdg
+{
+
+#if GDISP_NEED_PIXELREAD
+class Snapshot
+{
+public:
+  // writes the display contents as binary PPM, returns false on I/O errors
+  static bool save(GDisplay* g, const char* path)
+  {
+    FILE* f = fopen(path, "wb");
+    if(f == nullptr)
+    {
+      return false;
+    }
+    const coord_t w = gdispGGetWidth(g);
+    const coord_t h = gdispGGetHeight(g);
+    fprintf(f, "P6\n%d %d\n255\n", w, h);
+    for(coord_t y = 0; y < h; y++)
+    {
+      for(coord_t x = 0; x < w; x++)
+      {
+        color_t c = gdispGGetPixelColor(g, x, y);
+        unsigned char rgb[3] = {(unsigned char)RED_OF(c),
+                                (unsigned char)GREEN_OF(c),
+                                (unsigned char)BLUE_OF(c)};
+        fwrite(rgb, 1, 3, f);
+      }
+    }
+    return (fclose(f) == 0);
+  }
+
+  /* Compares the display against the reference PPM and returns the number of
+    differing pixels, or -1 if the reference can't be read or has a different
+    size. If diffPath is given and there are differences, an image is written
+    there that shows differing pixels in red on top of a dimmed copy of the
+    display.
+  */
+  static long compare(GDisplay* g, const char* referencePath,
+                      const char* diffPath = nullptr)
+  {
+    int w;
+    int h;
+    unsigned char* ref = load(referencePath, &w, &h);
+    if(ref == nullptr)
+    {
+      return -1;
+    }
+    if((w != gdispGGetWidth(g)) || (h != gdispGGetHeight(g)))
+    {
+      free(ref);
+      return -1;
+    }
+    long differences = 0;
+    for(int y = 0; y < h; y++)
+    {
+      for(int x = 0; x < w; x++)
+      {
+        unsigned char* p = &ref[3 * (y * w + x)];
+        color_t c = gdispGGetPixelColor(g, x, y);
+        bool same = (p[0] == (unsigned char)RED_OF(c)) &&
+                    (p[1] == (unsigned char)GREEN_OF(c)) &&
+                    (p[2] == (unsigned char)BLUE_OF(c));
+        if(!same)
+        {
+          differences++;
+          p[0] = 255;
+          p[1] = 0;
+          p[2] = 0;
+        }
+        else
+        {
+          p[0] = p[0] / 4;
+          p[1] = p[1] / 4;
+          p[2] = p[2] / 4;
+        }
+      }
+    }
+    if((differences != 0) && (diffPath != nullptr))
+    {
+      write(diffPath, ref, w, h);
+    }
+    free(ref);
+    return differences;
+  }
+
+private:
+  static unsigned char* load(const char* path, int* w, int* h)
+  {
+    FILE* f = fopen(path, "rb");
+    if(f == nullptr)
+    {
+      return nullptr;
+    }
+    int max;
+    unsigned char* data = nullptr;
+    if((fscanf(f, "P6 %d %d %d", w, h, &max) == 3) && (max == 255) &&
+       (fgetc(f) != EOF))
+    {
+      size_t n = 3 * (size_t)(*w) * (size_t)(*h);
+      data = (unsigned char*)malloc(n);
+      if((data != nullptr) && (fread(data, 1, n, f) != n))
+      {
+        free(data);
+        data = nullptr;
+      }
+    }
+    fclose(f);
+    return data;
+  }
+
+  static bool write(const char* path, const unsigned char* rgb, int w, int h)
+  {
+    FILE* f = fopen(path, "wb");
+    if(f == nullptr)
+    {
+      return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", w, h);
+    fwrite(rgb, 1, 3 * (size_t)w * (size_t)h, f);
+    return (fclose(f) == 0);
+  }
+};
+#endif // GDISP_NEED_PIXELREAD
+
+class OverdrawMap
+{
+public:
+  OverdrawMap(Length w, Length h) :
+    w_(w),
+    h_(h),
+    counts_((uint8_t*)calloc((size_t)w * h, 1))
+  {
+  }
+
+  ~OverdrawMap()
+  {
+    free(counts_);
+  }
+
+  void clear()
+  {
+    for(size_t i = 0; i < (size_t)w_ * h_; i++)
+    {
+      counts_[i] = 0;
+    }
+  }
+
+  // adds the pixel writes of all primitives in list
+  void add(const DrawList& list)
+  {
+    for(size_t i = 0; i < list.size(); i++)
+    {
+      const DrawList::Command& c = list[i];
+      const Rectangle& a = c.area;
+      if(c.type == DrawList::Command::eBox)
+      {
+        add(Rectangle(a.p0, Size(a.size.w, 1)), c.clip);
+        if(a.size.h > 1)
+        {
+          add(Rectangle(Point(a.p0.x, a.p0.y + a.size.h - 1), Size(a.size.w, 1)), c.clip);
+        }
+        if(a.size.h > 2)
+        {
+          add(Rectangle(Point(a.p0.x, a.p0.y + 1), Size(1, a.size.h - 2)), c.clip);
+          if(a.size.w > 1)
+          {
+            add(Rectangle(Point(a.p0.x + a.size.w - 1, a.p0.y + 1), Size(1, a.size.h - 2)), c.clip);
+          }
+        }
+      }
+      else
+      {
+        add(a, c.clip);
+      }
+    }
+  }
+
+  uint8_t count(Coordinate x, Coordinate y) const
+  {
+    return counts_[(size_t)y * w_ + x];
+  }
+
+  uint8_t max() const
+  {
+    uint8_t m = 0;
+    for(size_t i = 0; i < (size_t)w_ * h_; i++)
+    {
+      m = counts_[i] > m ? counts_[i] : m;
+    }
+    return m;
+  }
+
+  // total writes divided by the number of pixels written at least once
+  float average() const
+  {
+    unsigned long sum = 0;
+    unsigned long written = 0;
+    for(size_t i = 0; i < (size_t)w_ * h_; i++)
+    {
+      sum += counts_[i];
+      written += (counts_[i] != 0);
+    }
+    return written != 0 ? (float)sum / written : 0.0f;
+  }
+
+  /* Saves the counts as binary PPM: black for untouched pixels, then blue
+    (written once) through yellow to red (written maxCount times or
+    more).
+  */
+  bool save(const char* path, uint8_t maxCount = 4) const
+  {
+    FILE* f = fopen(path, "wb");
+    if(f == nullptr)
+    {
+      return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", w_, h_);
+    for(size_t i = 0; i < (size_t)w_ * h_; i++)
+    {
+      unsigned char rgb[3] = {0, 0, 0};
+      if(counts_[i] != 0)
+      {
+        // 0..255 from once to maxCount times
+        int t = maxCount > 1 ? 255 * (counts_[i] - 1) / (maxCount - 1) : 255;
+        t = t > 255 ? 255 : t;
+        rgb[0] = (unsigned char)(t > 128 ? 255 : 2 * t);
+        rgb[1] = (unsigned char)(t < 128 ? 2 * t : 2 * (255 - t));
+        rgb[2] = (unsigned char)(t < 128 ? 255 - 2 * t : 0);
+      }
+      fwrite(rgb, 1, 3, f);
+    }
+    return (fclose(f) == 0);
+  }
+
+private:
+  void add(const Rectangle& r, const Rectangle& clip)
+  {
+    Rectangle a = r & clip & Rectangle(Point(0, 0), Size(w_, h_));
+    for(Coordinate y = a.p0.y; y < a.p0.y + a.size.h; y++)
+    {
+      for(Coordinate x = a.p0.x; x < a.p0.x + a.size.w; x++)
+      {
+        uint8_t& c = counts_[(size_t)y * w_ + x];
+        c = c < 255 ? c + 1 : c;
+      }
+    }
+  }
+
+  OverdrawMap(const OverdrawMap&);
+  OverdrawMap& operator=(const OverdrawMap&);
+  Length w_;
+  Length h_;
+  uint8_t* counts_;
+};
+
+} // namespace uwdg
+
+#endif // UWDG_SNAPSHOT_H
@@ -2,13 +2,39 @@
 #define UWDG_STYLE_H
 
 #include <gfx.h>
+#include <string.h>
+
+#include "fonts.h"
+
+// number of palette entries
+#ifndef UWDG_PALETTE_SIZE
+#define UWDG_PALETTE_SIZE 16
+#endif
+
+// number of distinct styles, at most 32
+#ifndef UWDG_STYLES
+#define UWDG_STYLES 16
+#endif
 
 namespace uwdg
 {
 typedef color_t Color;
-typedef font_t Font;
 static constexpr Font DefaultFont = nullptr;
 
+typedef uint8_t PaletteIndex;
+typedef uint8_t StyleIndex;
+
+// palette entries used by the default style
+enum DefaultPalette
+{
+  ePaletteBlack,
+  ePaletteGray,
+  ePaletteWhite,
+  ePaletteOrange,
+  ePaletteYellow
+};
+
+// resolved style with native colors
 struct Style
 {
   struct ColorSet
@@ -16,14 +42,215 @@ struct Style
     Color fill;
     Color text;
     Color border;
+
+    bool operator==(const ColorSet& o) const
+    {
+      return (fill == o.fill) && (text == o.text) && (border == o.border);
+    }
   };
   Color background;
   ColorSet inactive;
   ColorSet active;
   ColorSet highlighted;
   ColorSet pressed;
-  Font font;
-  static Font defaultFont;
+  FontId font; // see FontRegistry
+
+  bool sameColors(const Style& o) const
+  {
+    return (background == o.background) && (inactive == o.inactive) &&
+           (active == o.active) && (highlighted == o.highlighted) &&
+           (pressed == o.pressed);
+  }
+
+  bool operator==(const Style& o) const
+  {
+    return sameColors(o) && (font == o.font);
+  }
+};
+
+// style description with colors as palette indices
+struct StyleSpec
+{
+  struct ColorSet
+  {
+    PaletteIndex fill;
+    PaletteIndex text;
+    PaletteIndex border;
+  };
+  PaletteIndex background;
+  ColorSet inactive;
+  ColorSet active;
+  ColorSet highlighted;
+  ColorSet pressed;
+  FontId font;
+};
+
+/* Interned styles.
+
+  Widgets refer to styles by a one byte index into this table, so any number
+  of widgets can share a style. Entries are either described by a StyleSpec,
+  whose colors are palette indices resolved once whenever the palette
+  changes, or given as a native Style that doesn't follow the palette.
+  intern() returns the index of an equal entry if there is one, so styles
+  built on the fly don't fill up the table. Entry 0 is the default style.
+
+  Entries can't be removed; when the table is full, intern() of a new style
+  returns invalid.
+*/
+class StyleTable
+{
+public:
+  static constexpr StyleIndex defaultIndex = 0;
+  static constexpr StyleIndex inherit = 0xFF;
+  static constexpr StyleIndex invalid = 0xFE; // intern() on a full table
+
+  static const Style& style(StyleIndex i)
+  {
+    return table().entries[i < table().count ? i : defaultIndex].resolved;
+  }
+
+  static uint8_t count()
+  {
+    return table().count;
+  }
+
+  // index of an equal entry, added if there is none; invalid if the table is full
+  static StyleIndex intern(const StyleSpec& spec)
+  {
+    Table& t = table();
+    for(StyleIndex i = 0; i < t.count; i++)
+    {
+      if(t.entries[i].paletted && (memcmp(&t.entries[i].spec, &spec, sizeof(spec)) == 0))
+      {
+        return i;
+      }
+    }
+    if(t.count == UWDG_STYLES)
+    {
+      return invalid;
+    }
+    set(t.count++, spec);
+    return t.count - 1;
+  }
+
+  static StyleIndex intern(const Style& style)
+  {
+    Table& t = table();
+    for(StyleIndex i = 0; i < t.count; i++)
+    {
+      if(!t.entries[i].paletted && (t.entries[i].resolved == style))
+      {
+        return i;
+      }
+    }
+    if(t.count == UWDG_STYLES)
+    {
+      return invalid;
+    }
+    set(t.count++, style);
+    return t.count - 1;
+  }
+
+  // replaces an entry, e.g. the default style; doesn't redraw anything
+  static void set(StyleIndex i, const StyleSpec& spec)
+  {
+    Entry& e = table().entries[i];
+    // zero the padding so interning can compare with memcmp
+    memset(&e.spec, 0, sizeof(e.spec));
+    e.spec.background = spec.background;
+    e.spec.inactive = spec.inactive;
+    e.spec.active = spec.active;
+    e.spec.highlighted = spec.highlighted;
+    e.spec.pressed = spec.pressed;
+    e.spec.font = spec.font;
+    e.paletted = true;
+    resolve(e);
+  }
+
+  static void set(StyleIndex i, const Style& style)
+  {
+    Entry& e = table().entries[i];
+    e.resolved = style;
+    e.paletted = false;
+  }
+
+  /*****************************************************************************
+  * Palette
+  *****************************************************************************/
+  static Color color(PaletteIndex i)
+  {
+    return table().palette[i < UWDG_PALETTE_SIZE ? i : 0];
+  }
+
+  /* Sets count palette entries starting at first and re-resolves all paletted
+    styles.
+    Returns a bit mask of the styles whose colors changed, see
+    Widget::setPalette() for a theme switch that redraws only those.
+  */
+  static uint32_t setPalette(const Color* colors, uint8_t count, PaletteIndex first = 0)
+  {
+    Table& t = table();
+    for(uint8_t i = 0; (i < count) && (first + i < UWDG_PALETTE_SIZE); i++)
+    {
+      t.palette[first + i] = colors[i];
+    }
+    uint32_t changed = 0;
+    for(StyleIndex i = 0; i < t.count; i++)
+    {
+      Entry& e = t.entries[i];
+      if(e.paletted)
+      {
+        Style old = e.resolved;
+        resolve(e);
+        if(!e.resolved.sameColors(old))
+        {
+          changed |= (1UL << i);
+        }
+      }
+    }
+    return changed;
+  }
+
+private:
+  static_assert(UWDG_STYLES <= 32, "style masks are 32 bits");
+
+  struct Entry
+  {
+    StyleSpec spec;
+    Style resolved;
+    bool paletted;
+  };
+
+  struct Table
+  {
+    Color palette[UWDG_PALETTE_SIZE];
+    Entry entries[UWDG_STYLES];
+    uint8_t count;
+  };
+
+  static Table& table()
+  {
+    // entry 0 exists from the start, Widget::init() fills it in
+    static Table t_ = {{}, {}, 1};
+    return t_;
+  }
+
+  static void resolveSet(Style::ColorSet& c, const StyleSpec::ColorSet& s)
+  {
+    c.fill = color(s.fill);
+    c.text = color(s.text);
+    c.border = color(s.border);
+  }
+
+  static void resolve(Entry& e)
+  {
+    e.resolved.background = color(e.spec.background);
+    resolveSet(e.resolved.inactive, e.spec.inactive);
+    resolveSet(e.resolved.active, e.spec.active);
+    resolveSet(e.resolved.highlighted, e.spec.highlighted);
+    resolveSet(e.resolved.pressed, e.spec.pressed);
+    e.resolved.font = e.spec.font;
+  }
 };
 } // namespace uwdg
 
@@ -0,0 +1,270 @@
+#ifndef UWDG_SUBTREECACHE_H
+#define UWDG_SUBTREECACHE_H
+
+#include <gfx.h>
+#include <stddef.h>
+
+#include "geometry.h"
+#include "lock.h"
+
+// number of subtrees that can be cached at the same time
+#ifndef UWDG_CACHED_SUBTREES
+#define UWDG_CACHED_SUBTREES 4
+#endif
+
+// limit for the pixel memory of all cached subtrees
+#ifndef UWDG_SUBTREE_CACHE_BUDGET
+#define UWDG_SUBTREE_CACHE_BUDGET 65536
+#endif
+
+namespace uwdg
+{
+
+#if GDISP_NEED_PIXMAP
+/* Off-screen pixmaps of widget subtrees, see Widget::setCached().
+
+  Pixmaps are allocated on first use and reused while the widget keeps its
+  size. When a new pixmap would exceed the budget, the least recently used
+  ones are freed; their widgets are rendered into a new pixmap when they are
+  drawn the next time, or drawn directly if even that doesn't fit.
+
+  Like BitmapCache, entries are pinned by the RenderContext that draws them
+  (see CachePins) for the rest of its pass, or by the DrawList it records
+  into until the list is cleared. Pinned entries are not evicted, so a
+  nested cached subtree can't free the pixmap its ancestor is rendering into
+  and recorded blits stay valid; release() of a pinned entry is deferred to
+  its last unpin. The cache is shared by all displays and locked.
+*/
+class SubtreeCache
+{
+public:
+  struct Entry
+  {
+    const void* owner;
+    GDisplay* pixmap;
+    Size size;
+    uint32_t lastUse;
+    uint8_t pins; // masks holding this entry
+    bool valid; // pixmap shows the current state of the subtree
+    bool blank; // nothing drawn into the pixmap yet
+
+    size_t bytes() const
+    {
+      return (size_t)size.w * size.h * sizeof(pixel_t);
+    }
+
+    const pixel_t* bits() const
+    {
+      return gdispPixmapGetBits(pixmap);
+    }
+  };
+
+  static SubtreeCache& instance()
+  {
+    static SubtreeCache c_;
+    return c_;
+  }
+
+  size_t budget() const
+  {
+    return budget_;
+  }
+
+  // pinned entries stay until they are released
+  void setBudget(size_t bytes)
+  {
+    Lock lock(mutex_);
+    budget_ = bytes;
+    while((bytes_ > budget_) && evictOldest())
+    {
+    }
+  }
+
+  // pixel memory in use
+  size_t bytes() const
+  {
+    return bytes_;
+  }
+
+  /* The entry of owner with a pixmap of the given size, allocated if needed
+    and added to pins if given. nullptr if it doesn't fit next to the pinned
+    entries.
+  */
+  Entry* acquire(const void* owner, const Size& size, uint32_t* pins = nullptr)
+  {
+    Lock lock(mutex_);
+    Entry* e = find(owner);
+    if((e != nullptr) && !((e->size.w == size.w) && (e->size.h == size.h)))
+    {
+      retire(*e);
+      e = nullptr;
+    }
+    if(e == nullptr)
+    {
+      const size_t needed = (size_t)size.w * size.h * sizeof(pixel_t);
+      if((needed == 0) || (needed > budget_))
+      {
+        return nullptr;
+      }
+      while(((bytes_ + needed > budget_) || ((e = freeSlot()) == nullptr)) &&
+            evictOldest())
+      {
+      }
+      if((bytes_ + needed > budget_) || (e == nullptr))
+      {
+        return nullptr; // the rest is pinned
+      }
+      e->pixmap = gdispPixmapCreate(size.w, size.h);
+      if(e->pixmap == nullptr)
+      {
+        return nullptr;
+      }
+      e->owner = owner;
+      e->size = size;
+      e->pins = 0;
+      e->valid = false;
+      e->blank = true;
+      bytes_ += needed;
+    }
+    e->lastUse = ++useCount_;
+    const uint32_t bit = 1UL << (e - entries_);
+    if((pins != nullptr) && !(*pins & bit))
+    {
+      *pins |= bit;
+      e->pins++;
+    }
+    return e;
+  }
+
+  // releases the entries in pins and clears it
+  void unpin(uint32_t& pins)
+  {
+    Lock lock(mutex_);
+    for(uint8_t i = 0; (i < UWDG_CACHED_SUBTREES) && (pins != 0); i++)
+    {
+      if(pins & (1UL << i))
+      {
+        pins &= ~(1UL << i);
+        Entry& e = entries_[i];
+        if((--e.pins == 0) && (e.owner == nullptr))
+        {
+          release(e); // released while pinned
+        }
+      }
+    }
+  }
+
+  // marks the pixmap of owner as outdated
+  void invalidate(const void* owner)
+  {
+    Lock lock(mutex_);
+    Entry* e = find(owner);
+    if(e != nullptr)
+    {
+      e->valid = false;
+    }
+  }
+
+  void release(const void* owner)
+  {
+    Lock lock(mutex_);
+    Entry* e = find(owner);
+    if(e != nullptr)
+    {
+      retire(*e);
+    }
+  }
+
+private:
+  SubtreeCache() :
+    budget_(UWDG_SUBTREE_CACHE_BUDGET),
+    bytes_(0),
+    useCount_(0)
+  {
+    for(Entry& e : entries_)
+    {
+      e.owner = nullptr;
+      e.pixmap = nullptr;
+      e.pins = 0;
+    }
+  }
+
+  static_assert(UWDG_CACHED_SUBTREES <= 32, "pin masks are 32 bits");
+
+  // entries released while pinned keep their pixmap, but no owner
+  Entry* find(const void* owner)
+  {
+    for(Entry& e : entries_)
+    {
+      if((e.owner == owner) && (e.pixmap != nullptr))
+      {
+        return &e;
+      }
+    }
+    return nullptr;
+  }
+
+  Entry* freeSlot()
+  {
+    for(Entry& e : entries_)
+    {
+      if(e.pixmap == nullptr)
+      {
+        return &e;
+      }
+    }
+    return nullptr;
+  }
+
+  // frees the least recently used unpinned entry, false if there is none
+  bool evictOldest()
+  {
+    Entry* oldest = nullptr;
+    for(Entry& e : entries_)
+    {
+      if((e.owner != nullptr) && (e.pins == 0) &&
+         ((oldest == nullptr) || (e.lastUse < oldest->lastUse)))
+      {
+        oldest = &e;
+      }
+    }
+    if(oldest == nullptr)
+    {
+      return false;
+    }
+    release(*oldest);
+    return true;
+  }
+
+  // releases e now, or when its last pin is released
+  void retire(Entry& e)
+  {
+    if(e.pins == 0)
+    {
+      release(e);
+    }
+    else
+    {
+      e.owner = nullptr;
+    }
+  }
+
+  void release(Entry& e)
+  {
+    bytes_ -= e.bytes();
+    gdispPixmapDelete(e.pixmap);
+    e.pixmap = nullptr;
+    e.owner = nullptr;
+  }
+
+  Entry entries_[UWDG_CACHED_SUBTREES];
+  size_t budget_;
+  size_t bytes_;
+  uint32_t useCount_;
+  Mutex mutex_;
+};
+#endif // GDISP_NEED_PIXMAP
+
+} // namespace uwdg
+
+#endif // UWDG_SUBTREECACHE_H
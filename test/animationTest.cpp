@@ -0,0 +1,196 @@
+/* Animations of a widget must end with the widget: tick() after deleting an
+  animated widget must not touch it. Animations run on the clock given to
+  tick(), with the eased values of their curve, damage the union of what
+  they move in one pass and leave what the budget doesn't allow for the
+  next tick().
+*/
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static int32_t lastValue = 0;
+
+static void setValue(int32_t v)
+{
+  lastValue = v;
+}
+
+class Probe
+{
+public:
+  Probe() : value(-1), delay(0) {}
+
+  void set(int32_t v)
+  {
+    value = v;
+    // a slow setter
+    const systemticks_t begin = gfxSystemTicks();
+    while(gfxSystemTicks() - begin < delay)
+    {
+    }
+  }
+
+  Animator::IntSetter setter()
+  {
+    return Animator::IntSetter(this, &Probe::set);
+  }
+
+  int32_t value;
+  systemticks_t delay;
+};
+
+// a clock that has nothing to do with gfxSystemTicks()
+static systemticks_t at(delaytime_t ms)
+{
+  return gfxMillisecondsToTicks(100000 + ms);
+}
+
+static void easing()
+{
+  Animator& a = Animator::instance();
+  Probe linear;
+  Probe in;
+  Probe out;
+  Probe inOut;
+  a.animate(linear.setter(), 0, 1000, 1000, Animator::eLinear);
+  a.animate(in.setter(), 0, 1000, 1000, Animator::eEaseIn);
+  a.animate(out.setter(), 0, 1000, 1000, Animator::eEaseOut);
+  a.animate(inOut.setter(), 0, 1000, 1000, Animator::eEaseInOut);
+  // the first tick is the start
+  a.tick(at(0));
+  CHECK((linear.value == 0) && (in.value == 0) && (out.value == 0) && (inOut.value == 0));
+  a.tick(at(250));
+  CHECK((linear.value == 250) && (in.value == 62) && (out.value == 437) && (inOut.value == 156));
+  a.tick(at(500));
+  CHECK((linear.value == 500) && (in.value == 250) && (out.value == 750) && (inOut.value == 500));
+  a.tick(at(1000));
+  CHECK((linear.value == 1000) && (in.value == 1000) && (out.value == 1000) &&
+        (inOut.value == 1000));
+  CHECK(!a.running());
+
+  // started long before the first tick: starts there, doesn't jump to the end
+  a.animate(linear.setter(), 0, 1000, 1000, Animator::eLinear);
+  a.tick(at(5000));
+  CHECK(linear.value == 0);
+  a.tick(at(5500));
+  CHECK(linear.value == 500);
+  a.tick(at(6000));
+  CHECK(!a.running());
+}
+
+static void combinedDamage()
+{
+  Animator& a = Animator::instance();
+  GDisplay* g = gdispPixmapCreate(200, 100);
+  Widget root;
+  root.setDisplay(g);
+  Widget first(&root);
+  first.setSize(20, 20);
+  Widget second(&root);
+  second.moveTo(Point(100, 50));
+  second.setSize(20, 20);
+  Widget::drawWidgets(g);
+
+  a.moveTo(&first, Point(30, 10), 100, Animator::eLinear);
+  a.moveTo(&second, Point(60, 70), 100, Animator::eLinear);
+  a.tick(at(0));
+  CHECK(!root.needsDrawing());
+  a.tick(at(100));
+  CHECK((first.position().x == 30) && (first.position().y == 10));
+  CHECK((second.position().x == 60) && (second.position().y == 70));
+  CHECK(!a.running());
+  // one pass repaints the old and new places of both, and nothing else
+  StaticDrawList<32> list;
+  Widget::recordWidgets(g, list);
+  CHECK(list.bounds() == Rectangle(Point(0, 0), Size(120, 90)));
+  CHECK(!root.needsDrawing());
+  list.clear();
+  gdispPixmapDelete(g);
+}
+
+static void frameSkipping()
+{
+  Animator& a = Animator::instance();
+  Probe probes[3];
+  for(Probe& p : probes)
+  {
+    p.delay = gfxMillisecondsToTicks(2);
+    a.animate(p.setter(), 0, 1000, 1000, Animator::eLinear);
+  }
+  const systemticks_t budget = gfxMillisecondsToTicks(1);
+  // one slow setter uses up the budget of a tick
+  a.tick(at(0), budget);
+  int set = 0;
+  int32_t sum = 0;
+  for(const Probe& p : probes)
+  {
+    set += p.value >= 0 ? 1 : 0;
+  }
+  CHECK(set == 1);
+  // the next tick goes on with the next one, the others keep their state
+  a.tick(at(500), budget);
+  set = 0;
+  for(const Probe& p : probes)
+  {
+    set += p.value >= 0 ? 1 : 0;
+    sum += p.value >= 0 ? p.value : 0;
+  }
+  CHECK((set == 2) && (sum == 500));
+  // skipped ones started with the others all the same
+  a.tick(at(500), budget);
+  sum = 0;
+  for(const Probe& p : probes)
+  {
+    sum += p.value;
+  }
+  CHECK(sum == 1000);
+  a.tick(at(1000));
+  CHECK((probes[0].value == 1000) && (probes[1].value == 1000) && (probes[2].value == 1000));
+  CHECK(!a.running());
+}
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  Animator& a = Animator::instance();
+
+  Widget root;
+  Widget* moving = new Widget(&root);
+  moving->setSize(20, 20);
+  Widget* growing = new Widget(moving);
+  Widget other(&root);
+  other.setSize(10, 10);
+
+  const Animator::handle_t move = a.moveTo(moving, Point(100, 50), 1000);
+  const Animator::handle_t resize = a.resize(growing, Size(30, 30), 1000);
+  const Animator::handle_t tagged =
+    a.animate(Animator::IntSetter(&setValue), 0, 100, 1000, Animator::eLinear, moving);
+  const Animator::handle_t kept = a.moveTo(&other, Point(50, 50), 1000);
+  CHECK(a.running(move) && a.running(resize) && a.running(tagged) && a.running(kept));
+
+  // the child goes first, then its parent with the tagged setter
+  delete growing;
+  CHECK(!a.running(resize));
+  CHECK(a.running(move) && a.running(tagged));
+  delete moving;
+  CHECK(!a.running(move));
+  CHECK(!a.running(tagged));
+  CHECK(a.running(kept));
+
+  // only the remaining animation is stepped
+  const systemticks_t now = gfxSystemTicks();
+  a.tick(now);
+  a.tick(now + gfxMillisecondsToTicks(2000));
+  CHECK(lastValue == 0);
+  CHECK(other.position().x == 50);
+  CHECK(!a.running());
+  CHECK(Widget::checkRoots());
+
+  easing();
+  combinedDamage();
+  frameSkipping();
+  return checkResult("animationTest");
+}
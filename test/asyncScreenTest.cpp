@@ -0,0 +1,156 @@
+/* AsyncScreen: the placeholder is shown while the coroutine builds the new
+  screen and is replaced by it at the end. The focus never moves in between,
+  so there are no onLooseFocus/onFocus/focusChanged calls until the new
+  screen takes it. Needs C++20.
+*/
+
+#include "check.h"
+#include "uwdg-simple.h"
+#include "asyncScreen.h"
+
+using namespace uwdg;
+
+// counts the focus callbacks
+class FocusButton : public Button
+{
+public:
+  FocusButton(const char* s, Widget* parent) :
+    Button(s, parent),
+    focused(0),
+    lost(0)
+  {
+  }
+
+  void onFocus() override
+  {
+    focused++;
+  }
+
+  void onLooseFocus() override
+  {
+    lost++;
+  }
+
+  int focused;
+  int lost;
+};
+
+static int focusChanges = 0;
+static Widget* lastFocused = nullptr;
+
+static void onFocusChanged(Widget* w)
+{
+  focusChanges++;
+  lastFocused = w;
+}
+
+static FocusButton* built = nullptr;
+
+static bool tookFocus = true;
+
+// two slices: the root, then a button that tries to grab the focus
+static ScreenTask buildScreen()
+{
+  Widget* root = new Widget;
+  co_await nextSlice();
+  built = new FocusButton("new", root);
+  tookFocus = built->giveFocus();
+  co_await nextSlice();
+  co_return root;
+}
+
+static bool isRoot(Widget* w)
+{
+  for(Widget* r = Widget::topRoot(GDISP); r != nullptr; r = r->next())
+  {
+    if(r == w)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  Widget::focusChanged().connect(&onFocusChanged);
+
+  Widget placeholder;
+  Widget current;
+  FocusButton ok("OK", &current);
+  Widget::raiseRoot(&current);
+  CHECK(Widget::focus() == &ok);
+  CHECK(ok.focused == 1);
+
+  {
+    AsyncScreen screen(buildScreen(), &placeholder);
+    // the placeholder is shown right away, without taking the focus
+    CHECK(Widget::topRoot(GDISP) == &placeholder);
+    CHECK(Widget::focus() == &ok);
+
+    focusChanges = 0;
+    // creating the root doesn't drop the focus
+    CHECK(!screen.step());
+    CHECK(Widget::checkRoots());
+    CHECK(Widget::topRoot(GDISP) == &placeholder);
+    CHECK(Widget::focus() == &ok);
+    CHECK((ok.focused == 1) && (ok.lost == 0));
+    CHECK(focusChanges == 0);
+
+    // and the new button can't take it
+    CHECK(!screen.step());
+    CHECK(Widget::topRoot(GDISP) == &placeholder);
+    CHECK(Widget::focus() == &ok);
+    CHECK(built != nullptr);
+    if(built != nullptr)
+    {
+      CHECK(!tookFocus);
+      CHECK((built->focused == 0) && (built->lost == 0));
+    }
+    CHECK((ok.focused == 1) && (ok.lost == 0));
+    CHECK(focusChanges == 0);
+
+    // done: the new root replaces the placeholder and gets the focus, once
+    CHECK(screen.step());
+    CHECK(Widget::checkRoots());
+    CHECK(screen.root() != nullptr);
+    CHECK(Widget::topRoot(GDISP) == screen.root());
+    CHECK(!isRoot(&placeholder));
+    CHECK(isRoot(&current));
+    CHECK(Widget::focus() == built);
+    if(built != nullptr)
+    {
+      CHECK((built->focused == 1) && (built->lost == 0));
+    }
+    CHECK((ok.focused == 1) && (ok.lost == 1));
+    CHECK(focusChanges == 1);
+    CHECK(lastFocused == built);
+
+    // back to the old screen, so the focus doesn't point at the deleted button
+    Widget::raiseRoot(&current);
+    Widget::removeRoot(screen.root());
+    delete built;
+    delete screen.root();
+  }
+
+  {
+    // without a placeholder the current screen stays on top meanwhile
+    Widget::raiseRoot(&current);
+    AsyncScreen screen(buildScreen());
+    CHECK(!screen.step());
+    CHECK(Widget::topRoot(GDISP) == &current);
+    CHECK(Widget::focus() == &ok);
+    CHECK(screen.step(gfxMillisecondsToTicks(100)));
+    CHECK(Widget::topRoot(GDISP) == screen.root());
+    CHECK(Widget::checkRoots());
+    // back to the old screen, so the focus doesn't point at the deleted button
+    Widget::raiseRoot(&current);
+    Widget::removeRoot(screen.root());
+    delete built;
+    delete screen.root();
+  }
+
+  return checkResult("asyncScreenTest");
+}
@@ -0,0 +1,132 @@
+/* BitmapCache entries that a recorded frame refers to must survive until the
+  frame is replayed, even if the cache has to make room in between. Drawing
+  directly, the bitmap must survive until it's blitted, even if the pass of
+  another display makes room in between.
+*/
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+// host images: 'H', 'I', width, height, seed
+static const uint8_t first[] = {'H', 'I', 16, 16, 1};
+static const uint8_t second[] = {'H', 'I', 16, 16, 2};
+static const size_t imageBytes = 16 * 16 * sizeof(pixel_t);
+
+/* Draws the first image, but before blitting it, requests the second one
+  like the pass of another display would, with room for only one of them.
+*/
+class Interleaved : public Widget
+{
+public:
+  Interleaved(Widget* parent) :
+    Widget(parent),
+    other(nullptr),
+    intact(false)
+  {
+  }
+
+  void draw(RenderContext& rc) const override
+  {
+    const BitmapCache::Bitmap* b = Image::bitmap(rc, first);
+    other = BitmapCache::instance().get(second);
+    intact = (b != nullptr) && (b->source == first) && (b->pixmap != nullptr);
+    Image::drawBitmap(rc, b, Rectangle(Point(0, 0), size()));
+  }
+
+  mutable const BitmapCache::Bitmap* other;
+  mutable bool intact;
+};
+
+static bool samePixels(GDisplay* a, GDisplay* b)
+{
+  const pixel_t* pa = gdispPixmapGetBits(a);
+  const pixel_t* pb = gdispPixmapGetBits(b);
+  for(size_t i = 0; i < (size_t)gdispGGetWidth(a) * gdispGGetHeight(a); i++)
+  {
+    if(pa[i] != pb[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  BitmapCache& cache = BitmapCache::instance();
+  GDisplay* recorded = gdispPixmapCreate(80, 40);
+  GDisplay* direct = gdispPixmapCreate(80, 40);
+
+  // room for one of the two images
+  cache.setBudget(imageBytes);
+  Widget root;
+  root.setDisplay(recorded);
+  Image a(first, &root);
+  a.moveTo(Point(5, 5));
+  a.setSize(30, 30);
+  Image b(second, &root);
+  b.moveTo(Point(45, 5));
+  b.setSize(30, 30);
+
+  {
+    // both images in one recording: the first one is flushed to make room
+    StaticDrawList<64> list;
+    Widget::recordWidgets(recorded, list);
+    CHECK(!list.complete());
+    CHECK(list.pins().bitmaps != 0);
+    list.replay();
+    list.clear();
+    CHECK(list.pins().bitmaps == 0);
+    CHECK(cache.stats().bytes <= cache.budget());
+  }
+  root.setDisplay(direct);
+  Widget::drawWidgets(direct);
+  CHECK(samePixels(recorded, direct));
+
+  {
+    // a pinned bitmap is not evicted, and an explicit eviction waits for the pin
+    cache.clear();
+    cache.resetStats();
+    cache.setBudget(2 * imageBytes);
+    uint32_t pins = 0;
+    const BitmapCache::Bitmap* pinned = cache.get(first, &pins);
+    CHECK(pinned != nullptr);
+    const pixel_t* bits = pinned->bits;
+    const pixel_t corner = bits[15 * 16 + 15];
+    cache.setBudget(imageBytes);
+    CHECK(cache.get(second) == nullptr); // the only room is pinned
+    cache.evict(first);
+    CHECK(cache.stats().bytes == imageBytes);
+    CHECK(bits[15 * 16 + 15] == corner); // still allocated
+    cache.unpin(pins);
+    CHECK(pins == 0);
+    CHECK(cache.stats().bytes == 0);
+    CHECK(cache.get(second) != nullptr);
+    CHECK(cache.get(first) != nullptr); // evicts the unpinned second
+    CHECK(cache.stats().evictions == 1);
+  }
+
+  {
+    // the other display can't evict the bitmap that this pass still blits
+    cache.clear();
+    cache.setBudget(imageBytes);
+    Widget other;
+    other.setDisplay(direct);
+    Interleaved w(&other);
+    w.setSize(20, 20);
+    Widget::drawWidgets(direct);
+    CHECK(w.intact);
+    CHECK(w.other == nullptr);
+    // the pin ends with the pass
+    CHECK(cache.get(second) != nullptr);
+  }
+
+  cache.clear();
+  gdispPixmapDelete(recorded);
+  gdispPixmapDelete(direct);
+  return checkResult("bitmapCacheTest");
+}
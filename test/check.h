@@ -0,0 +1,37 @@
+#ifndef UWDG_TEST_CHECK_H
+#define UWDG_TEST_CHECK_H
+
+#include <stdio.h>
+
+/* Minimal test support: CHECK() reports a failed condition with its location
+  and counts it, tests return checkResult() from main().
+*/
+
+inline int& checkFailures()
+{
+  static int n_ = 0;
+  return n_;
+}
+
+#define CHECK(cond) \
+  do \
+  { \
+    if(!(cond)) \
+    { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      checkFailures()++; \
+    } \
+  } while(0)
+
+inline int checkResult(const char* name)
+{
+  if(checkFailures() != 0)
+  {
+    fprintf(stderr, "%s: %d check(s) failed\n", name, checkFailures());
+    return 1;
+  }
+  printf("%s: ok\n", name);
+  return 0;
+}
+
+#endif // UWDG_TEST_CHECK_H
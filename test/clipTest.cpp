@@ -0,0 +1,84 @@
+/* Clip changes per pass: drawWidgets() reports the gdispGSetClip() calls of
+  its pass, which must match what the display saw. The clip is only changed
+  where a primitive would be affected by it, which for the nested tree below
+  are the children that stick out of their parents.
+*/
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  GDisplay* g = gdispPixmapCreate(160, 120);
+
+  Widget root;
+  root.setDisplay(g);
+  Widget panel(&root);
+  panel.moveTo(Point(10, 10));
+  panel.setSize(60, 40);
+  // inside the panel: no clip needed
+  Widget inside(&panel);
+  inside.moveTo(Point(5, 5));
+  inside.setSize(20, 10);
+  // sticks out of the panel at the bottom right
+  Widget outside(&panel);
+  outside.moveTo(Point(50, 30));
+  outside.setSize(40, 30);
+  // and its label out of it
+  Label label("clipped", &outside);
+  label.moveTo(Point(2, 2));
+  label.setSize(60, 12);
+
+  {
+    // the first primitive sets the clip, then outside and the label clip
+    // to their visible parts and the end of the pass resets it
+    const unsigned long before = g->clipChanges;
+    const RenderContext::Stats s = Widget::drawWidgets(g);
+    CHECK(s.clipChanges == 4);
+    CHECK(g->clipChanges - before == s.clipChanges);
+    // box and fill for 5 widgets, the label's text
+    CHECK(s.primitives == 11);
+  }
+
+  {
+    // idle: nothing
+    const unsigned long before = g->clipChanges;
+    const RenderContext::Stats s = Widget::drawWidgets(g);
+    CHECK((s.clipChanges == 0) && (s.primitives == 0));
+    CHECK(g->clipChanges == before);
+  }
+
+  {
+    // a widget that needs no clip: set once for the pass, reset at the end
+    inside.redraw();
+    const unsigned long before = g->clipChanges;
+    const RenderContext::Stats s = Widget::drawWidgets(g);
+    CHECK(s.clipChanges == 2);
+    CHECK(g->clipChanges - before == s.clipChanges);
+  }
+
+  {
+    // the clipped label: the same
+    label.redraw();
+    const RenderContext::Stats s = Widget::drawWidgets(g);
+    CHECK(s.clipChanges == 2);
+    CHECK(s.primitives == 3);
+  }
+
+  {
+    // both: the first sets it, outside and the label change it, the end resets it
+    inside.redraw();
+    outside.redraw();
+    const unsigned long before = g->clipChanges;
+    const RenderContext::Stats s = Widget::drawWidgets(g);
+    CHECK(s.clipChanges == 4);
+    CHECK(g->clipChanges - before == s.clipChanges);
+  }
+
+  gdispPixmapDelete(g);
+  return checkResult("clipTest");
+}
@@ -0,0 +1,83 @@
+/* Measures the cost of calling through a Delegate and a Signal against a raw
+  function pointer. The targets are not inlined, so the numbers compare the
+  call paths.
+
+  usage: delegateBench [calls]
+  calls per variant defaults to 50000000.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+#include "check.h"
+#include "delegate.h"
+
+using namespace uwdg;
+
+static volatile int sink = 0;
+
+__attribute__((noinline)) static void target(int n)
+{
+  sink = sink + n;
+}
+
+class Receiver
+{
+public:
+  __attribute__((noinline)) void target(int n)
+  {
+    sink = sink + n;
+  }
+};
+
+// the call site isn't inlined either, so the callable can't be devirtualized
+template <typename F>
+__attribute__((noinline)) static double nsPerCall(const F& f, long calls)
+{
+  const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  for(long i = 0; i < calls; i++)
+  {
+    f(1);
+  }
+  const std::chrono::steady_clock::duration d = std::chrono::steady_clock::now() - begin;
+  return std::chrono::duration<double, std::nano>(d).count() / calls;
+}
+
+int main(int argc, char** argv)
+{
+  long calls = argc > 1 ? atol(argv[1]) : 50000000;
+  calls = calls > 0 ? calls : 1;
+
+  Receiver receiver;
+  void (*volatile raw)(int) = &target;
+  void (*pointer)(int) = raw;
+  Delegate<void(int)> function(pointer);
+  Delegate<void(int)> member(&receiver, &Receiver::target);
+  Receiver* r = &receiver;
+  Delegate<void(int)> lambda([r](int n) {r->target(n);});
+  Signal<int> one;
+  one.connect(function);
+  Signal<int> two;
+  two.connect(function);
+  two.connect(member);
+
+  const double base = nsPerCall(pointer, calls);
+  printf("%ld calls each, ns per call (and relative to the raw pointer)\n", calls);
+  printf("raw function pointer   %6.2f\n", base);
+  const double f = nsPerCall(function, calls);
+  printf("Delegate, function     %6.2f  %5.2fx\n", f, f / base);
+  const double m = nsPerCall(member, calls);
+  printf("Delegate, member       %6.2f  %5.2fx\n", m, m / base);
+  const double l = nsPerCall(lambda, calls);
+  printf("Delegate, lambda       %6.2f  %5.2fx\n", l, l / base);
+  const double s1 = nsPerCall(one, calls);
+  printf("Signal, 1 slot         %6.2f  %5.2fx\n", s1, s1 / base);
+  const double s2 = nsPerCall(two, calls);
+  printf("Signal, 2 slots        %6.2f  %5.2fx\n", s2, s2 / base);
+
+  // all calls arrived: 1 per call, the two slot signal counts twice
+  CHECK(sink == (int)(calls * 7));
+  return checkResult("delegateBench");
+}
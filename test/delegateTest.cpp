@@ -0,0 +1,149 @@
+/* Delegate and Signal: calling free functions, member functions and lambdas,
+  equality (which must not depend on unused storage bytes), and connecting
+  and disconnecting slots.
+*/
+
+#include <string.h>
+
+#include <new>
+
+#include "check.h"
+#include "delegate.h"
+
+using namespace uwdg;
+
+static int freeCalls = 0;
+
+static void increment(int n)
+{
+  freeCalls += n;
+}
+
+static void decrement(int n)
+{
+  freeCalls -= n;
+}
+
+static int twice(int n)
+{
+  return 2 * n;
+}
+
+class Counter
+{
+public:
+  Counter() : total(0) {}
+
+  void add(int n)
+  {
+    total += n;
+  }
+
+  void subtract(int n)
+  {
+    total -= n;
+  }
+
+  int scaled(int n) const
+  {
+    return total * n;
+  }
+
+  int total;
+};
+
+typedef Delegate<void(int)> IntSlot;
+
+// builds a delegate in memory that was filled with garbage first
+template <typename... A>
+static IntSlot* inDirtyMemory(unsigned char* buffer, unsigned char fill, A... args)
+{
+  memset(buffer, fill, sizeof(IntSlot));
+  return new (buffer) IntSlot(args...);
+}
+
+int main()
+{
+  {
+    // calls
+    IntSlot f(&increment);
+    f(3);
+    CHECK(freeCalls == 3);
+    Counter c;
+    IntSlot m(&c, &Counter::add);
+    m(5);
+    CHECK(c.total == 5);
+    Delegate<int(int)> cm(&c, &Counter::scaled);
+    CHECK(cm(2) == 10);
+    Delegate<int(int)> r(&twice);
+    CHECK(r(21) == 42);
+    int captured = 0;
+    int* p = &captured;
+    IntSlot l([p](int n) {*p += n;});
+    l(7);
+    CHECK(captured == 7);
+    IntSlot empty;
+    CHECK(!empty);
+    CHECK(f && m && l);
+    IntSlot none(nullptr);
+    CHECK(!none);
+  }
+
+  {
+    // equality
+    Counter a;
+    Counter b;
+    CHECK(IntSlot(&increment) == IntSlot(&increment));
+    CHECK(IntSlot(&increment) != IntSlot(&decrement));
+    CHECK(IntSlot(&a, &Counter::add) == IntSlot(&a, &Counter::add));
+    CHECK(IntSlot(&a, &Counter::add) != IntSlot(&b, &Counter::add));
+    CHECK(IntSlot(&a, &Counter::add) != IntSlot(&a, &Counter::subtract));
+    CHECK(IntSlot(&increment) != IntSlot(&a, &Counter::add));
+    CHECK(IntSlot() == IntSlot(nullptr));
+    CHECK(IntSlot() != IntSlot(&increment));
+    int* p = &a.total;
+    IntSlot l([p](int n) {*p += n;});
+    IntSlot copy = l;
+    CHECK(copy == l);
+    CHECK(copy != IntSlot(&increment));
+
+    // the bytes after a small target are never written
+    alignas(IntSlot) unsigned char zeros[sizeof(IntSlot)];
+    alignas(IntSlot) unsigned char ones[sizeof(IntSlot)];
+    CHECK(*inDirtyMemory(zeros, 0x00, &increment) == *inDirtyMemory(ones, 0xFF, &increment));
+    CHECK(*inDirtyMemory(zeros, 0x00, &a, &Counter::add) ==
+          *inDirtyMemory(ones, 0xFF, &a, &Counter::add));
+  }
+
+  {
+    // signals
+    Counter a;
+    Counter b;
+    Signal<int> s;
+    s(1); // no slots
+    CHECK(s.connect(IntSlot(&a, &Counter::add)));
+    CHECK(s.connect(IntSlot(&b, &Counter::subtract)));
+#if UWDG_SIGNAL_SLOTS == 2
+    CHECK(!s.connect(IntSlot(&increment))); // full
+#endif
+    s(4);
+    CHECK((a.total == 4) && (b.total == -4));
+    s.disconnect(IntSlot(&b, &Counter::subtract));
+    s(1);
+    CHECK((a.total == 5) && (b.total == -4));
+    // disconnecting something that isn't connected does nothing
+    s.disconnect(IntSlot(&b, &Counter::add));
+    s(1);
+    CHECK(a.total == 6);
+    // the free slot is reused
+    freeCalls = 0;
+    CHECK(s.connect(IntSlot(&increment)));
+    s(2);
+    CHECK((a.total == 8) && (freeCalls == 2));
+    s.disconnectAll();
+    s(100);
+    CHECK((a.total == 8) && (freeCalls == 2));
+  }
+
+  return checkResult("delegateTest");
+}
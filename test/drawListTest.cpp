@@ -0,0 +1,144 @@
+/* DrawList::optimize(): replaying an optimized list must produce exactly the
+  pixels of the recorded one. Checked on a hand-built list, where the commands
+  that are hidden or merged are known, and on a recorded widget tree.
+*/
+
+#include <string.h>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+typedef DrawList::Command Command;
+
+static bool samePixels(GDisplay* a, GDisplay* b)
+{
+  const size_t n = (size_t)gdispGGetWidth(a) * gdispGGetHeight(a);
+  return memcmp(gdispPixmapGetBits(a), gdispPixmapGetBits(b), n * sizeof(pixel_t)) == 0;
+}
+
+static Command command(uint8_t type, Coordinate x, Coordinate y, Length cx, Length cy,
+                       Color color)
+{
+  Command c = Command();
+  c.type = type;
+  c.color = color;
+  c.area = Rectangle(Point(x, y), Size(cx, cy));
+  c.clip = Rectangle(Point(0, 0), Size(60, 40));
+  return c;
+}
+
+static bool is(const Command& c, uint8_t type, Coordinate x, Coordinate y, Length cx, Length cy)
+{
+  return (c.type == type) && (c.area == Rectangle(Point(x, y), Size(cx, cy)));
+}
+
+static size_t count(const DrawList& list, uint8_t type, Coordinate x, Coordinate y, Length cx,
+                    Length cy)
+{
+  size_t n = 0;
+  for(size_t i = 0; i < list.size(); i++)
+  {
+    n += is(list[i], type, x, y, cx, cy) ? 1 : 0;
+  }
+  return n;
+}
+
+static void handBuilt()
+{
+  GDisplay* recorded = gdispPixmapCreate(60, 40);
+  GDisplay* optimized = gdispPixmapCreate(60, 40);
+  StaticDrawList<16> list;
+  list.add(recorded, command(Command::eFill, 0, 0, 20, 20, Red));    // hidden by the blue fill
+  list.add(recorded, command(Command::eBox, 2, 2, 10, 10, White));   // hidden by the blue fill
+  Command text = command(Command::eString, 30, 0, 20, 10, White);
+  text.text = "x";
+  text.font = gdispOpenFont("UI2");
+  list.add(recorded, text);
+  list.add(recorded, command(Command::eFill, 0, 0, 25, 25, Blue));
+  list.add(recorded, command(Command::eFill, 0, 30, 10, 10, Green)); // three in a row
+  list.add(recorded, command(Command::eFill, 10, 30, 10, 10, Green));
+  list.add(recorded, command(Command::eFill, 20, 30, 10, 10, Green));
+  list.add(recorded, command(Command::eFill, 40, 20, 10, 10, Red));
+  list.add(recorded, command(Command::eBox, 35, 25, 10, 10, White)); // between the reds
+  list.add(recorded, command(Command::eFill, 40, 30, 10, 10, Red));
+  list.add(recorded, command(Command::eFill, 50, 0, 10, 10, Yellow)); // partly covered
+  list.add(recorded, command(Command::eFill, 55, 0, 10, 10, Black)); // clipped to 5 wide
+  CHECK(list.size() == 12);
+  list.replay(recorded);
+
+  list.optimize();
+  list.replay(optimized);
+  CHECK(samePixels(recorded, optimized));
+  CHECK(list.size() == 8);
+  if(list.size() == 8)
+  {
+    CHECK(is(list[0], Command::eString, 30, 0, 20, 10));
+    CHECK(is(list[1], Command::eFill, 0, 0, 25, 25));
+    CHECK(is(list[2], Command::eFill, 0, 30, 30, 10)); // merged
+    CHECK(is(list[3], Command::eFill, 40, 20, 10, 10)); // not merged over the box
+    CHECK(is(list[4], Command::eBox, 35, 25, 10, 10));
+    CHECK(is(list[5], Command::eFill, 40, 30, 10, 10));
+    CHECK(is(list[6], Command::eFill, 50, 0, 10, 10));
+    CHECK(is(list[7], Command::eFill, 55, 0, 5, 10));
+  }
+
+  // optimizing twice changes nothing
+  list.optimize();
+  CHECK(list.size() == 8);
+  gdispPixmapDelete(optimized);
+  gdispPixmapDelete(recorded);
+}
+
+static void widgetTree()
+{
+  GDisplay* recorded = gdispPixmapCreate(160, 120);
+  GDisplay* optimized = gdispPixmapCreate(160, 120);
+  Widget root;
+  root.setDisplay(recorded);
+  Widget panel(&root);
+  panel.moveTo(Point(10, 10));
+  panel.setSize(60, 40);
+  // its fill covers the panel's fill
+  Widget cover(&panel);
+  cover.setSize(60, 40);
+  Label label("label", &cover);
+  label.moveTo(Point(4, 4));
+  label.setSize(50, 14);
+  Gauge gauge(&root);
+  gauge.moveTo(Point(80, 10));
+  gauge.setSize(60, 60);
+  gauge.setRange(0, 100);
+  gauge.setValue(40);
+  ProgressBar bar(&root);
+  bar.moveTo(Point(10, 80));
+  bar.setSize(140, 16);
+  bar.setRange(0, 100);
+  bar.setValue(70);
+
+  StaticDrawList<64> list;
+  Widget::recordWidgets(recorded, list);
+  CHECK(list.complete());
+  const size_t before = list.size();
+  CHECK(count(list, Command::eFill, 11, 11, 58, 38) == 2);
+  list.replay(recorded);
+  list.optimize();
+  list.replay(optimized);
+  CHECK(samePixels(recorded, optimized));
+  // the panel's fill is gone, the cover's is left
+  CHECK(list.size() < before);
+  CHECK(count(list, Command::eFill, 11, 11, 58, 38) == 1);
+  list.clear();
+  gdispPixmapDelete(optimized);
+  gdispPixmapDelete(recorded);
+}
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  handBuilt();
+  widgetTree();
+  return checkResult("drawListTest");
+}
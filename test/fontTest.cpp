@@ -0,0 +1,70 @@
+/* FontRegistry: names that can't be opened resolve to the default font once,
+  instead of being retried on every use or preload step, and the registry can
+  be used from several threads.
+*/
+
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+int main()
+{
+  gfxInit();
+  FontRegistry& r = FontRegistry::instance();
+
+  const FontId missing = r.declare("NoSuchFont", true);
+  const FontId small = r.declare("UI1", true);
+  CHECK((missing != FontRegistry::invalid) && (small != FontRegistry::invalid));
+  CHECK(!r.isOpen(missing));
+
+  // one step per font, then preloading is done for good
+  CHECK(r.preloadStep());
+  CHECK(r.preloadStep());
+  CHECK(!r.preloadStep());
+  CHECK(!r.preloadStep());
+
+  CHECK(r.isOpen(FontRegistry::defaultId));
+  CHECK(r.isOpen(small));
+  CHECK(!r.isOpen(missing));
+  CHECK(r.font(missing) == r.font(FontRegistry::defaultId));
+  CHECK(r.font(missing) != nullptr);
+  CHECK(r.metrics(missing).lineHeight == r.metrics(FontRegistry::defaultId).lineHeight);
+  CHECK(r.find(r.font(missing)) == FontRegistry::defaultId);
+  CHECK(r.font(small) != r.font(FontRegistry::defaultId));
+
+  // a shared handle is closed only once, and resolved again afterwards
+  r.closeAll();
+  CHECK(!r.isOpen(FontRegistry::defaultId));
+  CHECK(r.font(missing) == r.font(FontRegistry::defaultId));
+
+  // concurrent lookups of fonts that aren't open yet
+  r.closeAll();
+  std::vector<std::thread> threads;
+  for(int t = 0; t < 4; t++)
+  {
+    threads.push_back(std::thread([&r]
+    {
+      for(int i = 0; i < 1000; i++)
+      {
+        FontId id = r.declare((i & 1) ? "UI1" : "NoSuchFont");
+        if(r.font(id) == nullptr)
+        {
+          checkFailures()++;
+        }
+        r.preloadStep();
+      }
+    }));
+  }
+  for(std::thread& t : threads)
+  {
+    t.join();
+  }
+  CHECK(r.isOpen(small));
+  CHECK(r.font(missing) == r.font(FontRegistry::defaultId));
+
+  return checkResult("fontTest");
+}
@@ -0,0 +1,374 @@
+#include "gfx.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <chrono>
+
+/*****************************************************************************
+* Colors and system
+*****************************************************************************/
+color_t gdispBlendColor(color_t fg, color_t bg, uint8_t alpha)
+{
+  const unsigned r = (RED_OF(fg) * alpha + RED_OF(bg) * (255 - alpha)) / 255;
+  const unsigned g = (GREEN_OF(fg) * alpha + GREEN_OF(bg) * (255 - alpha)) / 255;
+  const unsigned b = (BLUE_OF(fg) * alpha + BLUE_OF(bg) * (255 - alpha)) / 255;
+  return RGB2COLOR(r, g, b);
+}
+
+systemticks_t gfxSystemTicks()
+{
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return (systemticks_t)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
+systemticks_t gfxMillisecondsToTicks(delaytime_t ms)
+{
+  return ms * 1000;
+}
+
+void gfxInit()
+{
+}
+
+/*****************************************************************************
+* Displays
+*****************************************************************************/
+static GDisplay defaultDisplay(320, 240);
+GDisplay* GDISP = &defaultDisplay;
+
+GDisplay::GDisplay(coord_t w, coord_t h) :
+  width(w),
+  height(h),
+  clipx0(0),
+  clipy0(0),
+  clipx1(w),
+  clipy1(h),
+  pixels((size_t)w * h, 0),
+  clipChanges(0)
+{
+}
+
+static inline int maxOf(int a, int b)
+{
+  return a > b ? a : b;
+}
+
+static inline int minOf(int a, int b)
+{
+  return a < b ? a : b;
+}
+
+static inline void setPixel(GDisplay* g, int x, int y, color_t c)
+{
+  if((x >= g->clipx0) && (x < g->clipx1) && (y >= g->clipy0) && (y < g->clipy1))
+  {
+    g->pixels[(size_t)y * g->width + x] = c;
+  }
+}
+
+coord_t gdispGGetWidth(GDisplay* g)
+{
+  return g->width;
+}
+
+coord_t gdispGGetHeight(GDisplay* g)
+{
+  return g->height;
+}
+
+void gdispGSetClip(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy)
+{
+  g->clipx0 = maxOf(x, 0);
+  g->clipy0 = maxOf(y, 0);
+  g->clipx1 = minOf(x + cx, g->width);
+  g->clipy1 = minOf(y + cy, g->height);
+  g->clipChanges++;
+}
+
+void gdispGDrawPixel(GDisplay* g, coord_t x, coord_t y, color_t color)
+{
+  setPixel(g, x, y, color);
+}
+
+color_t gdispGGetPixelColor(GDisplay* g, coord_t x, coord_t y)
+{
+  if((x < 0) || (y < 0) || (x >= g->width) || (y >= g->height))
+  {
+    return 0;
+  }
+  return g->pixels[(size_t)y * g->width + x];
+}
+
+void gdispGFillArea(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color)
+{
+  const int x0 = maxOf(x, g->clipx0);
+  const int y0 = maxOf(y, g->clipy0);
+  const int x1 = minOf(x + cx, g->clipx1);
+  const int y1 = minOf(y + cy, g->clipy1);
+  for(int j = y0; j < y1; j++)
+  {
+    for(int i = x0; i < x1; i++)
+    {
+      g->pixels[(size_t)j * g->width + i] = color;
+    }
+  }
+}
+
+void gdispGDrawBox(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color)
+{
+  if((cx <= 0) || (cy <= 0))
+  {
+    return;
+  }
+  gdispGFillArea(g, x, y, cx, 1, color);
+  gdispGFillArea(g, x, y + cy - 1, cx, 1, color);
+  gdispGFillArea(g, x, y, 1, cy, color);
+  gdispGFillArea(g, x + cx - 1, y, 1, cy, color);
+}
+
+void gdispGDrawLine(GDisplay* g, coord_t x0, coord_t y0, coord_t x1, coord_t y1, color_t color)
+{
+  const int dx = x1 - x0;
+  const int dy = y1 - y0;
+  const int n = maxOf(dx < 0 ? -dx : dx, dy < 0 ? -dy : dy);
+  if(n == 0)
+  {
+    setPixel(g, x0, y0, color);
+    return;
+  }
+  for(int i = 0; i <= n; i++)
+  {
+    // round to nearest, symmetric around zero
+    const int ox = (2 * dx * i + (dx < 0 ? -n : n)) / (2 * n);
+    const int oy = (2 * dy * i + (dy < 0 ? -n : n)) / (2 * n);
+    setPixel(g, x0 + ox, y0 + oy, color);
+  }
+}
+
+void gdispGFillArc(GDisplay* g, coord_t x, coord_t y, coord_t radius,
+                   coord_t startangle, coord_t endangle, color_t color)
+{
+  int start = ((startangle % 360) + 360) % 360;
+  int end = ((endangle % 360) + 360) % 360;
+  const bool full = (start == end) && (startangle != endangle);
+  for(int j = -radius; j <= radius; j++)
+  {
+    for(int i = -radius; i <= radius; i++)
+    {
+      if(i * i + j * j > radius * radius)
+      {
+        continue;
+      }
+      int a = (int)floor(atan2(-j, i) * 180.0 / M_PI);
+      a = (a + 360) % 360;
+      const bool inside = full || ((start <= end) ? ((a >= start) && (a <= end))
+                                                  : ((a >= start) || (a <= end)));
+      if(inside)
+      {
+        setPixel(g, x + i, y + j, color);
+      }
+    }
+  }
+}
+
+void gdispGBlitArea(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy,
+                    coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t* buffer)
+{
+  for(int j = maxOf(0, g->clipy0 - y); j < minOf(cy, g->clipy1 - y); j++)
+  {
+    for(int i = maxOf(0, g->clipx0 - x); i < minOf(cx, g->clipx1 - x); i++)
+    {
+      g->pixels[(size_t)(y + j) * g->width + x + i] =
+        buffer[(size_t)(srcy + j) * srccx + srcx + i];
+    }
+  }
+}
+
+void gdispGVerticalScroll(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy,
+                          int lines, color_t bgcolor)
+{
+  const int x0 = maxOf(x, g->clipx0);
+  const int y0 = maxOf(y, g->clipy0);
+  const int x1 = minOf(x + cx, g->clipx1);
+  const int y1 = minOf(y + cy, g->clipy1);
+  if(lines >= 0)
+  {
+    for(int j = y0; j < y1; j++)
+    {
+      for(int i = x0; i < x1; i++)
+      {
+        g->pixels[(size_t)j * g->width + i] =
+          (j + lines < y1) ? g->pixels[(size_t)(j + lines) * g->width + i] : bgcolor;
+      }
+    }
+  }
+  else
+  {
+    for(int j = y1 - 1; j >= y0; j--)
+    {
+      for(int i = x0; i < x1; i++)
+      {
+        g->pixels[(size_t)j * g->width + i] =
+          (j + lines >= y0) ? g->pixels[(size_t)(j + lines) * g->width + i] : bgcolor;
+      }
+    }
+  }
+}
+
+GDisplay* gdispPixmapCreate(coord_t width, coord_t height)
+{
+  return new GDisplay(width, height);
+}
+
+void gdispPixmapDelete(GDisplay* g)
+{
+  delete g;
+}
+
+pixel_t* gdispPixmapGetBits(GDisplay* g)
+{
+  return g->pixels.data();
+}
+
+/*****************************************************************************
+* Fonts
+*****************************************************************************/
+static const mf_font_s fonts[] = {
+  {"UI2", 6, 10},
+  {"UI1", 5, 8}
+};
+
+font_t gdispOpenFont(const char* name)
+{
+  for(const mf_font_s& f : fonts)
+  {
+    if(strcmp(f.short_name, name) == 0)
+    {
+      return &f;
+    }
+  }
+  return nullptr;
+}
+
+void gdispCloseFont(font_t)
+{
+}
+
+coord_t gdispGetFontMetric(font_t font, fontmetric_t metric)
+{
+  switch(metric)
+  {
+    case fontHeight:
+    case fontLineSpacing:
+      return font->height;
+    case fontMinWidth:
+    case fontMaxWidth:
+      return font->width;
+    case fontCharPadding:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+coord_t gdispGetStringWidth(const char* str, font_t font)
+{
+  return (coord_t)(strlen(str) * font->width);
+}
+
+// a pattern of the character code in the cell, leaving the last column and the top and bottom row empty
+static void drawGlyph(GDisplay* g, int x, int y, unsigned char c, font_t font, color_t color)
+{
+  if(c == ' ')
+  {
+    return;
+  }
+  for(int j = 1; j < font->height - 1; j++)
+  {
+    const unsigned row = (c * (2 * j + 1)) ^ (c >> (j % 4));
+    for(int i = 0; i < font->width - 1; i++)
+    {
+      if(row & (1u << i))
+      {
+        setPixel(g, x + i, y + j, color);
+      }
+    }
+  }
+}
+
+void gdispGDrawStringBox(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy,
+                         const char* str, font_t font, color_t color, justify_t justify)
+{
+  // clip to the box
+  const coord_t saved[4] = {g->clipx0, g->clipy0, g->clipx1, g->clipy1};
+  g->clipx0 = maxOf(g->clipx0, x);
+  g->clipy0 = maxOf(g->clipy0, y);
+  g->clipx1 = minOf(g->clipx1, x + cx);
+  g->clipy1 = minOf(g->clipy1, y + cy);
+  const int w = gdispGetStringWidth(str, font);
+  int left = x;
+  if(justify == justifyCenter)
+  {
+    left += (cx - w + 1) / 2;
+  }
+  else if(justify == justifyRight)
+  {
+    left += cx - w;
+  }
+  const int top = y + (cy - font->height + 1) / 2;
+  for(size_t i = 0; str[i] != '\0'; i++)
+  {
+    drawGlyph(g, left + (int)i * font->width, top, (unsigned char)str[i], font, color);
+  }
+  g->clipx0 = saved[0];
+  g->clipy0 = saved[1];
+  g->clipx1 = saved[2];
+  g->clipy1 = saved[3];
+}
+
+/*****************************************************************************
+* Images
+*****************************************************************************/
+void gdispImageInit(gdispImage* img)
+{
+  img->width = 0;
+  img->height = 0;
+  img->data = nullptr;
+}
+
+gdispImageError gdispImageOpenMemory(gdispImage* img, const void* memimage)
+{
+  const uint8_t* d = (const uint8_t*)memimage;
+  if((d == nullptr) || (d[0] != 'H') || (d[1] != 'I') || (d[2] == 0) || (d[3] == 0))
+  {
+    return GDISP_IMAGE_ERR_BADFORMAT;
+  }
+  img->width = d[2];
+  img->height = d[3];
+  img->data = d;
+  return GDISP_IMAGE_ERR_OK;
+}
+
+void gdispImageClose(gdispImage* img)
+{
+  img->data = nullptr;
+}
+
+gdispImageError gdispGImageDraw(GDisplay* g, gdispImage* img, coord_t x, coord_t y,
+                                coord_t cx, coord_t cy, coord_t sx, coord_t sy)
+{
+  const unsigned seed = img->data[4];
+  for(int j = 0; (j < cy) && (sy + j < img->height); j++)
+  {
+    for(int i = 0; (i < cx) && (sx + i < img->width); i++)
+    {
+      const unsigned u = sx + i;
+      const unsigned v = sy + j;
+      setPixel(g, x + i, y + j,
+               RGB2COLOR((u * 255) / img->width, (v * 255) / img->height, seed * 37));
+    }
+  }
+  return GDISP_IMAGE_ERR_OK;
+}
@@ -0,0 +1,174 @@
+#ifndef UWDG_TEST_HOST_GFX_H
+#define UWDG_TEST_HOST_GFX_H
+
+/* The part of the ugfx API that uwdg uses, implemented in software for the
+  host tests.
+
+  Displays are RGB565 framebuffers in memory, so every display can be read
+  back, and pixmaps are ordinary displays. Rendering is deterministic: fonts
+  are fixed-size cells with a glyph pattern derived from the character code,
+  and images use a small format of their own (see gdispImageOpenMemory()),
+  which is all the tests need to compare frames pixel by pixel. Unknown font
+  names and undecodable images fail, so the error paths can be tested.
+
+  To run the tests against the real ugfx instead, point GFXINC and GFXSRC
+  in the Makefile at it.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+#include <vector>
+
+#include "gfxconf.h"
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
+
+typedef int bool_t;
+typedef int16_t coord_t;
+typedef uint16_t color_t;
+typedef color_t pixel_t;
+typedef uint32_t systemticks_t;
+typedef uint32_t delaytime_t;
+
+/*****************************************************************************
+* Colors
+*****************************************************************************/
+#define RGB2COLOR(r, g, b) ((color_t)((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | (((b) & 0xF8) >> 3)))
+#define HTML2COLOR(h) RGB2COLOR(((h) >> 16) & 0xFF, ((h) >> 8) & 0xFF, (h) & 0xFF)
+#define RED_OF(c) (((c) & 0xF800) >> 8)
+#define GREEN_OF(c) (((c) & 0x07E0) >> 3)
+#define BLUE_OF(c) (((c) & 0x001F) << 3)
+
+#define White HTML2COLOR(0xFFFFFF)
+#define Black HTML2COLOR(0x000000)
+#define Gray HTML2COLOR(0x808080)
+#define Grey Gray
+#define Blue HTML2COLOR(0x0000FF)
+#define Red HTML2COLOR(0xFF0000)
+#define Green HTML2COLOR(0x008000)
+#define Yellow HTML2COLOR(0xFFFF00)
+#define Orange HTML2COLOR(0xFFA500)
+
+color_t gdispBlendColor(color_t fg, color_t bg, uint8_t alpha);
+
+/*****************************************************************************
+* System
+*****************************************************************************/
+// ticks are microseconds of a monotonic clock
+systemticks_t gfxSystemTicks();
+systemticks_t gfxMillisecondsToTicks(delaytime_t ms);
+void gfxInit();
+
+typedef std::mutex gfxMutex;
+inline void gfxMutexInit(gfxMutex*) {}
+inline void gfxMutexDestroy(gfxMutex*) {}
+inline void gfxMutexEnter(gfxMutex* m) {m->lock();}
+inline void gfxMutexExit(gfxMutex* m) {m->unlock();}
+
+/*****************************************************************************
+* Displays
+*****************************************************************************/
+struct GDisplay
+{
+  GDisplay(coord_t w, coord_t h);
+
+  coord_t width;
+  coord_t height;
+  coord_t clipx0; // clip, end exclusive
+  coord_t clipy0;
+  coord_t clipx1;
+  coord_t clipy1;
+  std::vector<pixel_t> pixels;
+  unsigned long clipChanges; // gdispGSetClip() calls
+};
+
+// the default display, 320x240
+extern GDisplay* GDISP;
+
+coord_t gdispGGetWidth(GDisplay* g);
+coord_t gdispGGetHeight(GDisplay* g);
+void gdispGSetClip(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy);
+void gdispGDrawPixel(GDisplay* g, coord_t x, coord_t y, color_t color);
+color_t gdispGGetPixelColor(GDisplay* g, coord_t x, coord_t y);
+void gdispGFillArea(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
+void gdispGDrawBox(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
+void gdispGDrawLine(GDisplay* g, coord_t x0, coord_t y0, coord_t x1, coord_t y1, color_t color);
+// angles in degrees, counterclockwise from 3 o'clock
+void gdispGFillArc(GDisplay* g, coord_t x, coord_t y, coord_t radius,
+                   coord_t startangle, coord_t endangle, color_t color);
+void gdispGBlitArea(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy,
+                    coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t* buffer);
+// lines > 0 moves the contents up
+void gdispGVerticalScroll(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy,
+                          int lines, color_t bgcolor);
+
+GDisplay* gdispPixmapCreate(coord_t width, coord_t height);
+void gdispPixmapDelete(GDisplay* g);
+pixel_t* gdispPixmapGetBits(GDisplay* g);
+
+/*****************************************************************************
+* Fonts
+*****************************************************************************/
+typedef enum
+{
+  justifyLeft = 0,
+  justifyCenter = 1,
+  justifyRight = 2
+} justify_t;
+
+typedef enum
+{
+  fontHeight,
+  fontDescendersHeight,
+  fontLineSpacing,
+  fontCharPadding,
+  fontMinWidth,
+  fontMaxWidth
+} fontmetric_t;
+
+struct mf_font_s
+{
+  const char* short_name;
+  coord_t width;  // of a character cell
+  coord_t height;
+};
+typedef const struct mf_font_s* font_t;
+
+// "UI2" (6x10) and "UI1" (5x8); nullptr for other names
+font_t gdispOpenFont(const char* name);
+void gdispCloseFont(font_t font);
+coord_t gdispGetFontMetric(font_t font, fontmetric_t metric);
+coord_t gdispGetStringWidth(const char* str, font_t font);
+// the text is centered vertically and clipped to the box
+void gdispGDrawStringBox(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy,
+                         const char* str, font_t font, color_t color, justify_t justify);
+
+/*****************************************************************************
+* Images
+*****************************************************************************/
+typedef uint16_t gdispImageError;
+#define GDISP_IMAGE_ERR_OK 0
+#define GDISP_IMAGE_ERR_BADFORMAT 1
+
+struct gdispImage
+{
+  coord_t width;
+  coord_t height;
+  const uint8_t* data;
+};
+
+/* The host image format: 'H', 'I', width, height, seed. The pixels are a
+  pattern derived from the seed.
+*/
+void gdispImageInit(gdispImage* img);
+gdispImageError gdispImageOpenMemory(gdispImage* img, const void* memimage);
+void gdispImageClose(gdispImage* img);
+gdispImageError gdispGImageDraw(GDisplay* g, gdispImage* img, coord_t x, coord_t y,
+                                coord_t cx, coord_t cy, coord_t sx, coord_t sy);
+
+#endif // UWDG_TEST_HOST_GFX_H
@@ -0,0 +1,12 @@
+#ifndef UWDG_TEST_HOST_GFXCONF_H
+#define UWDG_TEST_HOST_GFXCONF_H
+
+// everything the host gfx implements is enabled
+#define GDISP_NEED_ARC TRUE
+#define GDISP_NEED_IMAGE TRUE
+#define GDISP_NEED_MULTITHREAD TRUE
+#define GDISP_NEED_PIXELREAD TRUE
+#define GDISP_NEED_PIXMAP TRUE
+#define GDISP_NEED_SCROLL TRUE
+
+#endif // UWDG_TEST_HOST_GFXCONF_H
@@ -0,0 +1,148 @@
+/* Cost of drawWidgets() on idle frames and on frames where one label changed,
+  over several tree sizes. The tree is a scrolled list of panels of which only
+  the first few are on the display, so most subtrees are clipped away.
+
+  Also checks that a pass leaves nothing to draw behind, in clipped subtrees
+  too, and that a change deep in a clipped subtree still reaches the root.
+
+  usage: idleBench [frames]
+  frames per measurement defaults to 100000.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <vector>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+// panels of two rows of five labels, one below the other
+class List
+{
+public:
+  List(GDisplay* g, int panels)
+  {
+    root_.setDisplay(g);
+    for(int i = 0; i < panels; i++)
+    {
+      Widget* panel = new Widget(&root_);
+      panel->moveTo(Point(10, 10 + 44 * i));
+      panel->setSize(300, 40);
+      widgets_.push_back(panel);
+      for(int r = 0; r < 2; r++)
+      {
+        Widget* row = new Widget(panel);
+        row->moveTo(Point(0, 2 + 19 * r));
+        row->setSize(300, 18);
+        widgets_.push_back(row);
+        for(int k = 0; k < 5; k++)
+        {
+          Label* label = new Label("value", row);
+          label->moveTo(Point(60 * k, 0));
+          label->setSize(58, 18);
+          widgets_.push_back(label);
+          labels_.push_back(label);
+        }
+      }
+    }
+  }
+
+  ~List()
+  {
+    // children first
+    for(size_t i = widgets_.size(); i > 0; i--)
+    {
+      delete widgets_[i - 1];
+    }
+  }
+
+  bool clean() const
+  {
+    for(Widget* w : widgets_)
+    {
+      if(w->needsDrawing())
+      {
+        return false;
+      }
+    }
+    return !root_.needsDrawing();
+  }
+
+  size_t size() const
+  {
+    return widgets_.size() + 1;
+  }
+
+  Widget root_;
+  std::vector<Widget*> widgets_;
+  std::vector<Label*> labels_;
+};
+
+static double nanoseconds(std::chrono::steady_clock::duration d)
+{
+  return std::chrono::duration<double, std::nano>(d).count();
+}
+
+int main(int argc, char** argv)
+{
+  int frames = argc > 1 ? atoi(argv[1]) : 100000;
+  frames = frames > 0 ? frames : 1;
+
+  gfxInit();
+  Widget::init();
+  GDisplay* g = gdispPixmapCreate(320, 240);
+
+  printf("%d frames per measurement\n", frames);
+  printf("  widgets  first pass (us)  idle (ns/frame)  one label (us/frame)\n");
+  const int sizes[] = {1, 10, 100, 1000};
+  for(int panels : sizes)
+  {
+    List list(g, panels);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    Widget::drawWidgets(g);
+    const double first = nanoseconds(std::chrono::steady_clock::now() - begin) / 1000;
+    CHECK(list.clean());
+
+    bool drewNothing = true;
+    begin = std::chrono::steady_clock::now();
+    for(int f = 0; f < frames; f++)
+    {
+      drewNothing &= (Widget::drawWidgets(g).primitives == 0);
+    }
+    const double idle = nanoseconds(std::chrono::steady_clock::now() - begin) / frames;
+    CHECK(drewNothing);
+
+    // the changes are few and small, so fewer frames do
+    const int changes = frames / 100 > 0 ? frames / 100 : 1;
+    Label* visible = list.labels_[0];
+    begin = std::chrono::steady_clock::now();
+    for(int f = 0; f < changes; f++)
+    {
+      visible->setText((f & 1) ? "value" : "other");
+      Widget::drawWidgets(g);
+    }
+    const double one = nanoseconds(std::chrono::steady_clock::now() - begin) / changes / 1000;
+    CHECK(list.clean());
+    printf("%9zu %16.2f %16.2f %21.2f\n", list.size(), first, idle, one);
+
+    if(panels > 10)
+    {
+      // a label in a panel below the display: the pass draws nothing
+      Label* hidden = list.labels_.back();
+      hidden->redraw();
+      CHECK(list.root_.needsDrawing());
+      CHECK(Widget::drawWidgets(g).primitives == 0);
+      CHECK(list.clean());
+      hidden->redraw();
+      CHECK(list.root_.needsDrawing());
+      Widget::drawWidgets(g);
+    }
+  }
+
+  gdispPixmapDelete(g);
+  return checkResult("idleBench");
+}
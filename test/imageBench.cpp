@@ -0,0 +1,108 @@
+/* Measures BitmapCache behaviour on an icon grid that pages through more
+  icons than fit into the cache: frame time and hits, misses, evictions,
+  failed gets and decode time per frame, for budgets from a full cache down
+  to a third of a page. Every budget must produce the same frames.
+
+  usage: imageBench [frames]
+  frames defaults to 200.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static const Length displayWidth = 320;
+static const Length displayHeight = 240;
+static const uint8_t iconSize = 32;
+static const int columns = 4;
+static const int rows = 3;
+static const int icons = 16;
+static const int pageIcons = 6; // shown twice each, the page moves on by one per frame
+
+// host images: 'H', 'I', width, height, seed
+static uint8_t iconData[icons][5];
+
+int main(int argc, char** argv)
+{
+  int frames = argc > 1 ? atoi(argv[1]) : 200;
+  frames = frames > 0 ? frames : 1;
+
+  gfxInit();
+  Widget::init();
+  for(int i = 0; i < icons; i++)
+  {
+    const uint8_t d[5] = {'H', 'I', iconSize, iconSize, (uint8_t)(i + 1)};
+    std::copy(d, d + 5, iconData[i]);
+  }
+
+  GDisplay* g = gdispPixmapCreate(displayWidth, displayHeight);
+  Widget root;
+  root.setDisplay(g);
+  std::vector<Image*> grid;
+  for(int y = 0; y < rows; y++)
+  {
+    for(int x = 0; x < columns; x++)
+    {
+      Image* image = new Image(nullptr, &root);
+      image->moveTo(Point(x * (displayWidth / columns), y * (displayHeight / rows)));
+      image->setSize(displayWidth / columns, displayHeight / rows);
+      grid.push_back(image);
+    }
+  }
+
+  BitmapCache& cache = BitmapCache::instance();
+  const size_t iconBytes = (size_t)iconSize * iconSize * sizeof(pixel_t);
+  static const size_t budgets[] = {UWDG_BITMAPS, pageIcons, pageIcons / 2, pageIcons / 3};
+  const size_t pixels = (size_t)displayWidth * displayHeight;
+  std::vector<pixel_t> reference;
+  printf("%dx%d, %zu images, %d icons, %d per page, %d frames\n", displayWidth, displayHeight,
+         grid.size(), icons, pageIcons, frames);
+  printf("budget  ms/frame   hits/f  misses/f  evictions/f  failures/f  decode ms/f\n");
+  for(size_t budget : budgets)
+  {
+    cache.clear();
+    cache.setBudget(budget * iconBytes);
+    cache.resetStats();
+    std::chrono::steady_clock::duration total(0);
+    for(int f = 0; f < frames; f++)
+    {
+      for(size_t i = 0; i < grid.size(); i++)
+      {
+        grid[i]->setSource(iconData[(f + i % pageIcons) % icons]);
+      }
+      const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+      Widget::drawWidgets(g);
+      total += std::chrono::steady_clock::now() - begin;
+    }
+    const pixel_t* bits = gdispPixmapGetBits(g);
+    if(reference.empty())
+    {
+      reference.assign(bits, bits + pixels);
+    }
+    const bool same = std::equal(reference.begin(), reference.end(), bits);
+    const BitmapCache::Stats& s = cache.stats();
+    printf("%6zu  %8.3f %8.1f  %8.1f  %11.1f  %10.1f  %11.3f%s\n", budget,
+           std::chrono::duration<double, std::milli>(total).count() / frames,
+           (double)s.hits / frames, (double)s.misses / frames, (double)s.evictions / frames,
+           (double)s.failures / frames, s.decodeTicks / 1000.0 / frames,
+           same ? "" : "  DIFFERENT PIXELS");
+    CHECK(same);
+    CHECK(s.bytes <= cache.budget());
+  }
+
+  for(Image* image : grid)
+  {
+    delete image;
+  }
+  cache.clear();
+  gdispPixmapDelete(g);
+  return checkResult("imageBench");
+}
@@ -0,0 +1,174 @@
+/* InputFilter: scripted key sequences with explicit times check debouncing,
+  auto-repeat with acceleration and batching, and long-press events.
+*/
+
+#include <vector>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+struct Event
+{
+  InputEvent::EInputType type;
+  bool press;
+  bool release;
+  bool longPress;
+  bool repeat;
+  uint16_t count;
+  systemticks_t time;
+};
+
+// takes the focus and records every event it gets
+class Recorder : public Widget
+{
+public:
+  Recorder(Widget* parent) :
+    Widget(parent)
+  {
+    setAcceptsFocus(true);
+  }
+
+  void onInputEvent(InputEvent& e) override
+  {
+    Event r = {e.type(), e.isPress(), e.isRelease(), e.isLongPress(), e.isRepeat(),
+               e.count(), e.time()};
+    events.push_back(r);
+    e.accept();
+  }
+
+  std::vector<Event> events;
+};
+
+static const systemticks_t t0 = gfxMillisecondsToTicks(1000);
+
+static systemticks_t at(delaytime_t ms)
+{
+  return t0 + gfxMillisecondsToTicks(ms);
+}
+
+static bool isPress(const Event& e, InputEvent::EInputType type, delaytime_t ms,
+                    uint16_t count = 1, bool repeat = false)
+{
+  return e.press && (e.type == type) && (e.time == at(ms)) && (e.count == count) &&
+         (e.repeat == repeat);
+}
+
+static bool isRelease(const Event& e, InputEvent::EInputType type, delaytime_t ms)
+{
+  return e.release && (e.type == type) && (e.time == at(ms));
+}
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  Widget root;
+  Recorder recorder(&root);
+  root.giveFocus();
+  std::vector<Event>& events = recorder.events;
+
+  {
+    // debounce: edges count from the last bounce, glitches are dropped
+    InputFilter filter;
+    filter.setDebounce(20);
+    filter.setKey(InputEvent::eEnter, true, at(0));
+    filter.setKey(InputEvent::eEnter, false, at(5));
+    filter.setKey(InputEvent::eEnter, true, at(8));
+    filter.process(at(20));
+    CHECK(events.empty());
+    filter.process(at(28));
+    CHECK(events.size() == 1);
+    CHECK((events.size() == 1) && isPress(events[0], InputEvent::eEnter, 8));
+    // enter doesn't repeat by default
+    filter.process(at(2000));
+    CHECK(events.size() == 1);
+    filter.setKey(InputEvent::eEnter, false, at(2100));
+    filter.process(at(2110));
+    CHECK(events.size() == 1);
+    filter.process(at(2120));
+    CHECK((events.size() == 2) && isRelease(events[1], InputEvent::eEnter, 2100));
+    filter.setKey(InputEvent::eEnter, true, at(2200));
+    filter.setKey(InputEvent::eEnter, false, at(2205));
+    filter.process(at(2300));
+    CHECK(events.size() == 2);
+    events.clear();
+  }
+
+  {
+    // repeats after 500 ms, then every 200, 100, 50 and at least 40 ms;
+    // repeats that are due at the same call come as one event
+    InputFilter filter;
+    filter.setDebounce(20);
+    filter.setRepeat(500, 200, 40, 128);
+    filter.setKey(InputEvent::eRight, true, at(0));
+    filter.process(at(20));
+    CHECK((events.size() == 1) && isPress(events[0], InputEvent::eRight, 0));
+    filter.process(at(499));
+    CHECK(events.size() == 1);
+    filter.process(at(500));
+    CHECK((events.size() == 2) && isPress(events[1], InputEvent::eRight, 500, 1, true));
+    filter.process(at(805)); // 700 and 800
+    CHECK((events.size() == 3) && isPress(events[2], InputEvent::eRight, 700, 2, true));
+    filter.process(at(935)); // 850, 890 and 930
+    CHECK((events.size() == 4) && isPress(events[3], InputEvent::eRight, 850, 3, true));
+    filter.process(at(969));
+    CHECK(events.size() == 4);
+    filter.process(at(970));
+    CHECK((events.size() == 5) && isPress(events[4], InputEvent::eRight, 970, 1, true));
+    filter.setKey(InputEvent::eRight, false, at(1000));
+    filter.process(at(1020));
+    CHECK((events.size() == 6) && isRelease(events[5], InputEvent::eRight, 1000));
+    filter.process(at(2000));
+    CHECK(events.size() == 6);
+    events.clear();
+  }
+
+  {
+    // long-press fires once, at the time it was reached
+    InputFilter filter;
+    filter.setDebounce(20);
+    filter.setLongPress(800);
+    filter.setLongPressKeys(1 << InputEvent::eEnter);
+    filter.setKey(InputEvent::eEnter, true, at(0));
+    filter.process(at(20));
+    filter.process(at(700));
+    CHECK((events.size() == 1) && isPress(events[0], InputEvent::eEnter, 0));
+    filter.process(at(900));
+    CHECK(events.size() == 2);
+    CHECK((events.size() == 2) && events[1].longPress && (events[1].time == at(800)));
+    filter.process(at(3000));
+    CHECK(events.size() == 2);
+    filter.setKey(InputEvent::eEnter, false, at(3000));
+    filter.process(at(3020));
+    CHECK((events.size() == 3) && isRelease(events[2], InputEvent::eEnter, 3000));
+    // released before the long-press time: none
+    filter.setKey(InputEvent::eEnter, true, at(4000));
+    filter.process(at(4020));
+    filter.setKey(InputEvent::eEnter, false, at(4500));
+    filter.process(at(4520));
+    filter.process(at(6000));
+    CHECK((events.size() == 5) && !events[3].longPress && !events[4].longPress);
+    events.clear();
+  }
+
+  {
+    // keys are independent: one event per key and call
+    InputFilter filter;
+    filter.setDebounce(20);
+    filter.setKey(InputEvent::eLeft, true, at(0));
+    filter.setKey(InputEvent::eDown, true, at(3));
+    filter.process(at(30));
+    CHECK(events.size() == 2);
+    CHECK((events.size() == 2) && isPress(events[0], InputEvent::eLeft, 0) &&
+          isPress(events[1], InputEvent::eDown, 3));
+    // without repeats for them
+    filter.setRepeatKeys(0);
+    filter.process(at(5000));
+    CHECK(events.size() == 2);
+    events.clear();
+  }
+
+  return checkResult("inputFilterTest");
+}
@@ -0,0 +1,116 @@
+/* Event-to-photon latency with UWDG_LATENCY_TRACE: a 50 fps loop where every
+  frame dispatches the input that arrived during the previous frame (at a
+  pseudo-random time in it) and then draws. Prints the percentiles and the
+  histogram of the LatencyTracer.
+
+  A second display is drawn between dispatch and the first display's pass;
+  its pass must not complete the traces of the first display.
+
+  usage: latencyBench [frames]
+  frames defaults to 2000.
+*/
+
+#ifndef UWDG_LATENCY_TRACE
+#error "build with -DUWDG_LATENCY_TRACE"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static const systemticks_t framePeriod = gfxMillisecondsToTicks(20);
+
+int main(int argc, char** argv)
+{
+  int frames = argc > 1 ? atoi(argv[1]) : 2000;
+  frames = frames > 0 ? frames : 1;
+
+  gfxInit();
+  Widget::init();
+  GDisplay* g = gdispPixmapCreate(320, 240);
+  GDisplay* other = gdispPixmapCreate(160, 120);
+
+  // a menu on the first display
+  Widget menu;
+  menu.setDisplay(g);
+  for(int i = 0; i < 8; i++)
+  {
+    Button* b = new Button("item", &menu);
+    b->moveTo(Point(10, 10 + 28 * i));
+    b->setSize(140, 24);
+  }
+  Label status("0", &menu);
+  status.moveTo(Point(170, 10));
+  status.setSize(140, 16);
+  status.setPartialUpdate(true);
+  menu.giveFocus();
+
+  // a clock on the second one
+  Widget clockRoot;
+  clockRoot.setDisplay(other);
+  Label clock("00:00", &clockRoot);
+  clock.setSize(80, 16);
+  Widget::raiseRoot(&menu);
+
+  Widget::drawWidgets(g);
+  Widget::drawWidgets(other);
+  LatencyTracer& tracer = LatencyTracer::instance();
+  tracer.reset();
+  uint32_t seed = 1;
+  char text[16];
+  for(int f = 0; f < frames; f++)
+  {
+    seed = seed * 1103515245 + 12345;
+    const systemticks_t arrived = gfxSystemTicks() - (seed >> 8) % framePeriod;
+    InputEvent event((f % 16) < 8 ? InputEvent::eDown : InputEvent::eUp,
+                     InputEvent::ePressed, arrived);
+    Widget::dispatchInputEvent(event);
+    snprintf(text, sizeof(text), "%d", f);
+    status.setText(text);
+
+    const uint32_t before = tracer.histogram().count();
+    snprintf(text, sizeof(text), "%02d:%02d", f / 60 % 60, f % 60);
+    clock.setText(text);
+    Widget::drawWidgets(other);
+    CHECK(tracer.histogram().count() == before);
+    Widget::drawWidgets(g);
+    CHECK(tracer.histogram().count() == before + 1);
+    CHECK(tracer.pending() == 0);
+  }
+
+  const LatencyHistogram& h = tracer.histogram();
+  printf("%u events, %u dropped, latency in us (input to end of pass)\n", h.count(),
+         tracer.dropped());
+  printf("p50 %u  p90 %u  p99 %u  max %u\n", h.p50(), h.percentile(90), h.p99(), h.max());
+  printf("       from         to    events\n");
+  for(uint8_t i = 0; i < LatencyHistogram::numBuckets; i++)
+  {
+    if(h.bucketCount(i) != 0)
+    {
+      printf("%11u %10u %9u\n", LatencyHistogram::bucketLow(i), LatencyHistogram::bucketHigh(i),
+             h.bucketCount(i));
+    }
+  }
+  CHECK(h.count() == (uint32_t)frames);
+  CHECK(h.max() >= h.p99());
+  CHECK(tracer.last().stages == (LatencyTracer::eDispatched | LatencyTracer::eFocusChanged |
+                                 LatencyTracer::eDamaged | LatencyTracer::eFlushed));
+  CHECK(tracer.last().display == g);
+
+  for(Widget* w = menu.children(); w != nullptr;)
+  {
+    Widget* next = w->next();
+    if(w != &status)
+    {
+      delete w;
+    }
+    w = next;
+  }
+  gdispPixmapDelete(other);
+  gdispPixmapDelete(g);
+  return checkResult("latencyBench");
+}
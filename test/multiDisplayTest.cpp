@@ -0,0 +1,115 @@
+/* Two displays drawn from two threads at the same time: every thread changes
+  and draws only its own display's tree, and the frames that come out must
+  be the ones a full redraw produces afterwards. The focus is on the first
+  display and stays there.
+
+  usage: multiDisplayTest [frames]
+  frames per thread defaults to 500.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static const Length displayWidth = 160;
+static const Length displayHeight = 120;
+
+// a panel of values that change every frame
+class Panel
+{
+public:
+  Panel(GDisplay* g) :
+    display_(g),
+    title_("panel", &root_),
+    gauge_(&root_),
+    bar_(&root_),
+    button_("focus", &root_)
+  {
+    root_.setDisplay(g);
+    title_.moveTo(Point(4, 4));
+    title_.setSize(100, 14);
+    title_.setPartialUpdate(true);
+    gauge_.moveTo(Point(4, 22));
+    gauge_.setSize(60, 60);
+    gauge_.setRange(0, 100);
+    bar_.moveTo(Point(4, 90));
+    bar_.setSize(150, 14);
+    bar_.setRange(0, 100);
+    button_.moveTo(Point(80, 40));
+    button_.setSize(70, 20);
+  }
+
+  void run(int frames, int seed)
+  {
+    for(int f = 0; f < frames; f++)
+    {
+      snprintf(text_, sizeof(text_), "frame %d", f);
+      title_.setText(text_);
+      gauge_.setValue((f * 7 + seed) % 101);
+      bar_.setValue((f * 13 + seed) % 101);
+      Widget::drawWidgets(display_);
+    }
+  }
+
+  std::vector<pixel_t> pixels() const
+  {
+    const pixel_t* bits = gdispPixmapGetBits(display_);
+    return std::vector<pixel_t>(bits, bits + (size_t)displayWidth * displayHeight);
+  }
+
+  GDisplay* display_;
+  Widget root_;
+  Label title_;
+  Gauge gauge_;
+  ProgressBar bar_;
+  Button button_;
+  char text_[24];
+};
+
+int main(int argc, char** argv)
+{
+  int frames = argc > 1 ? atoi(argv[1]) : 500;
+  frames = frames > 0 ? frames : 1;
+
+  gfxInit();
+  Widget::init();
+  GDisplay* first = gdispPixmapCreate(displayWidth, displayHeight);
+  GDisplay* second = gdispPixmapCreate(displayWidth, displayHeight);
+  // all roots are created before the threads start
+  Panel a(first);
+  Panel b(second);
+  a.button_.giveFocus();
+  Widget* const focus = Widget::focus();
+  CHECK(focus == &a.button_);
+
+  std::thread ta(&Panel::run, &a, frames, 0);
+  std::thread tb(&Panel::run, &b, frames, 50);
+  ta.join();
+  tb.join();
+  CHECK(Widget::focus() == focus);
+  CHECK(!a.root_.needsDrawing() && !b.root_.needsDrawing());
+
+  // the same frames from scratch, one display after the other
+  const std::vector<pixel_t> drawnA = a.pixels();
+  const std::vector<pixel_t> drawnB = b.pixels();
+  a.root_.redraw();
+  b.root_.redraw();
+  Widget::drawWidgets(first);
+  Widget::drawWidgets(second);
+  CHECK(a.pixels() == drawnA);
+  CHECK(b.pixels() == drawnB);
+  // and the displays differ: the focus and the values
+  CHECK(drawnA != drawnB);
+
+  gdispPixmapDelete(second);
+  gdispPixmapDelete(first);
+  return checkResult("multiDisplayTest");
+}
@@ -0,0 +1,118 @@
+/* Partial updates must produce exactly the pixels of a full draw: after every
+  value or text change, the partially updated frame is compared against a
+  full redraw of the same state.
+*/
+
+#include <string.h>
+
+#include <vector>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static const Length displayWidth = 120;
+static const Length displayHeight = 80;
+
+// differing pixels between the partial update just drawn and a full redraw
+static long partialVsFull(Widget& root)
+{
+  GDisplay* g = root.display();
+  const size_t n = (size_t)displayWidth * displayHeight;
+  std::vector<pixel_t> partial(gdispPixmapGetBits(g), gdispPixmapGetBits(g) + n);
+  root.redraw();
+  Widget::drawWidgets(g);
+  const pixel_t* full = gdispPixmapGetBits(g);
+  long differences = 0;
+  for(size_t i = 0; i < n; i++)
+  {
+    differences += (partial[i] != full[i]);
+  }
+  return differences;
+}
+
+static void values(Widget& root, ValueWidget& w, const char* name)
+{
+  static const ValueWidget::Value sequence[] = {70, 30, 50, 49, 50, 100, 0, 1, 99, 35};
+  Widget::drawWidgets(root.display());
+  for(ValueWidget::Value v : sequence)
+  {
+    w.setValue(v);
+    Widget::drawWidgets(root.display());
+    const long differences = partialVsFull(root);
+    if(differences != 0)
+    {
+      fprintf(stderr, "%s: %ld differing pixels at %d\n", name, differences, v);
+    }
+    CHECK(differences == 0);
+  }
+}
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  GDisplay* g = gdispPixmapCreate(displayWidth, displayHeight);
+
+  {
+    Widget root;
+    root.setDisplay(g);
+    Gauge gauge(&root);
+    gauge.moveTo(Point(10, 10));
+    gauge.setSize(80, 44);
+    gauge.setKind(Gauge::eSector);
+    values(root, gauge, "sector");
+    gauge.setKind(Gauge::eNeedle);
+    values(root, gauge, "needle");
+  }
+
+  {
+    Widget root;
+    root.setDisplay(g);
+    ProgressBar bar(&root);
+    bar.moveTo(Point(10, 10));
+    bar.setSize(90, 12);
+    values(root, bar, "horizontal bar");
+  }
+
+  {
+    Widget root;
+    root.setDisplay(g);
+    ProgressBar bar(&root);
+    bar.setOrientation(ProgressBar::eVertical);
+    bar.moveTo(Point(10, 10));
+    bar.setSize(12, 60);
+    values(root, bar, "vertical bar");
+  }
+
+  {
+    static const Label::Alignment alignments[] = {Label::left, Label::center, Label::right};
+    static const char* const texts[] = {"0000", "0042", "1", "12345", "0042", ""};
+    for(Label::Alignment a : alignments)
+    {
+      Widget root;
+      root.setDisplay(g);
+      Label label("0000", &root);
+      label.moveTo(Point(10, 10));
+      label.setSize(80, 16);
+      label.setAlignment(a);
+      label.setPartialUpdate(true);
+      Widget::drawWidgets(g);
+      for(const char* t : texts)
+      {
+        label.setText(t);
+        Widget::drawWidgets(g);
+        const long differences = partialVsFull(root);
+        if(differences != 0)
+        {
+          fprintf(stderr, "label %d: %ld differing pixels at \"%s\"\n", a, differences, t);
+        }
+        CHECK(differences == 0);
+      }
+    }
+  }
+
+  gdispPixmapDelete(g);
+  return checkResult("partialUpdateTest");
+}
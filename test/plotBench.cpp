@@ -0,0 +1,95 @@
+/* Measures how many samples per second a Plot takes: addSample() alone, and
+  with a frame drawn after every batch of samples, in sweep and scroll mode
+  and with different decimations.
+
+  usage: plotBench [seconds]
+  seconds of samples per configuration defaults to 1 (at 1 kHz, 50 fps).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static const Length displayWidth = 320;
+static const Length displayHeight = 240;
+static const uint32_t sampleRate = 1000;
+static const uint32_t frameRate = 50;
+
+static Plot::Sample sample(uint32_t i)
+{
+  const int32_t t = i % 200;
+  return (t < 100 ? t : 200 - t) * 60 - 3000;
+}
+
+static double seconds(std::chrono::steady_clock::duration d)
+{
+  return std::chrono::duration<double>(d).count();
+}
+
+int main(int argc, char** argv)
+{
+  double duration = argc > 1 ? atof(argv[1]) : 1.0;
+  duration = duration > 0 ? duration : 1.0;
+  const uint32_t samples = (uint32_t)(duration * sampleRate);
+  const uint32_t perFrame = sampleRate / frameRate;
+
+  gfxInit();
+  Widget::init();
+  GDisplay* g = gdispPixmapCreate(displayWidth, displayHeight);
+  Widget root;
+  root.setDisplay(g);
+  StaticPlot<512> plot(&root);
+  plot.moveTo(Point(10, 10));
+  plot.setSize(300, 220);
+  plot.setRange(-4000, 4000);
+
+  printf("%u samples per configuration, %u per frame\n", samples, perFrame);
+  printf("mode    samples/column  add Msamples/s  drawn Msamples/s  us/frame\n");
+  static const Plot::Mode modes[] = {Plot::eSweep, Plot::eScroll};
+  static const uint16_t decimations[] = {1, 4, 16};
+  for(Plot::Mode mode : modes)
+  {
+    for(uint16_t n : decimations)
+    {
+      plot.setMode(mode);
+      plot.setSamplesPerColumn(n);
+
+      // addSample() only, no frames in between
+      plot.clear();
+      std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+      for(uint32_t i = 0; i < samples; i++)
+      {
+        plot.addSample(sample(i));
+      }
+      const double added = seconds(std::chrono::steady_clock::now() - begin);
+
+      // a frame after every batch
+      plot.clear();
+      Widget::drawWidgets(g);
+      uint32_t frames = 0;
+      begin = std::chrono::steady_clock::now();
+      for(uint32_t i = 0; i < samples; i += perFrame)
+      {
+        for(uint32_t k = i; k < i + perFrame; k++)
+        {
+          plot.addSample(sample(k));
+        }
+        Widget::drawWidgets(g);
+        frames++;
+      }
+      const double drawn = seconds(std::chrono::steady_clock::now() - begin);
+      printf("%-6s  %14u  %14.2f  %16.2f  %8.2f\n", mode == Plot::eSweep ? "sweep" : "scroll", n,
+             samples / added / 1e6, samples / drawn / 1e6, drawn * 1e6 / frames);
+      CHECK(!root.needsDrawing());
+    }
+  }
+
+  gdispPixmapDelete(g);
+  return checkResult("plotBench");
+}
@@ -0,0 +1,119 @@
+/* Plot: incremental updates in sweep and scroll mode must produce exactly the
+  pixels of a full draw, also when the chart is partly clipped by its parent
+  and so can't scroll. Changing the decimation redraws the chart.
+*/
+
+#include <vector>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static const Length displayWidth = 120;
+static const Length displayHeight = 100;
+
+// differing pixels between the update just drawn and a full redraw
+static long partialVsFull(Widget& root)
+{
+  GDisplay* g = root.display();
+  const size_t n = (size_t)displayWidth * displayHeight;
+  std::vector<pixel_t> partial(gdispPixmapGetBits(g), gdispPixmapGetBits(g) + n);
+  root.redraw();
+  Widget::drawWidgets(g);
+  const pixel_t* full = gdispPixmapGetBits(g);
+  long differences = 0;
+  for(size_t i = 0; i < n; i++)
+  {
+    differences += (partial[i] != full[i]);
+  }
+  return differences;
+}
+
+// a triangle wave with a few spikes
+static Plot::Sample sample(uint32_t i)
+{
+  const int32_t t = i % 64;
+  const int32_t v = (t < 32 ? t : 64 - t) * 200 - 3200;
+  return (i % 23 == 0) ? 3000 : v;
+}
+
+static void addBatches(Widget& root, Plot& plot, const char* name)
+{
+  // the last batch is longer than the chart, which redraws it
+  static const uint16_t batches[] = {1, 1, 3, 7, 1, 20, 2, 150, 5};
+  uint32_t i = 0;
+  Widget::drawWidgets(root.display());
+  for(uint16_t n : batches)
+  {
+    for(uint16_t k = 0; k < n; k++)
+    {
+      plot.addSample(sample(i++));
+    }
+    Widget::drawWidgets(root.display());
+    const long differences = partialVsFull(root);
+    if(differences != 0)
+    {
+      fprintf(stderr, "%s: %ld differing pixels after %u samples\n", name, differences, i);
+    }
+    CHECK(differences == 0);
+  }
+}
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  GDisplay* g = gdispPixmapCreate(displayWidth, displayHeight);
+
+  {
+    Widget root;
+    root.setDisplay(g);
+    StaticPlot<128> plot(&root);
+    plot.moveTo(Point(10, 10));
+    plot.setSize(80, 50);
+    plot.setRange(-4000, 4000);
+    addBatches(root, plot, "sweep");
+    plot.clear();
+    plot.setSamplesPerColumn(3);
+    addBatches(root, plot, "sweep, 3 per column");
+
+    plot.clear();
+    plot.setSamplesPerColumn(1);
+    plot.setMode(Plot::eScroll);
+    addBatches(root, plot, "scroll");
+    plot.clear();
+    plot.setSamplesPerColumn(3);
+    addBatches(root, plot, "scroll, 3 per column");
+
+    // decimation changes what the columns mean
+    Widget::drawWidgets(g);
+    CHECK(!plot.needsDrawing());
+    plot.setSamplesPerColumn(3);
+    CHECK(!plot.needsDrawing());
+    plot.setSamplesPerColumn(5);
+    CHECK(plot.needsDrawing());
+  }
+
+  {
+    // the newest rows are clipped away at the bottom of the panel
+    Widget root;
+    root.setDisplay(g);
+    Widget panel(&root);
+    panel.moveTo(Point(10, 10));
+    panel.setSize(80, 50);
+    StaticPlot<128> plot(&panel);
+    plot.moveTo(Point(5, 10));
+    plot.setSize(60, 60);
+    plot.setRange(-4000, 4000);
+    plot.setMode(Plot::eScroll);
+    addBatches(root, plot, "clipped scroll");
+    // and at the top
+    plot.clear();
+    plot.moveTo(Point(5, -20));
+    addBatches(root, plot, "clipped scroll, top");
+  }
+
+  gdispPixmapDelete(g);
+  return checkResult("plotTest");
+}
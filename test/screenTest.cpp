@@ -0,0 +1,109 @@
+/* Screen images: trees of Widget, Label and Button round-trip through
+  ScreenWriter and Screen, anything else is rejected by the writer, including
+  classes derived from supported ones.
+*/
+
+#include <string.h>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+// inherits Label's classId(), but can't be restored from an image
+class Clock : public Label
+{
+public:
+  Clock(Widget* parent) :
+    Label("12:00", parent),
+    seconds_(0)
+  {
+  }
+
+  void tick()
+  {
+    seconds_++;
+  }
+
+private:
+  uint32_t seconds_;
+};
+
+static bool sameWidget(const Widget& a, const Widget& b)
+{
+  return (a.classId() == b.classId()) &&
+         (a.position().x == b.position().x) && (a.position().y == b.position().y) &&
+         (a.width() == b.width()) && (a.height() == b.height()) &&
+         (a.transparent() == b.transparent()) &&
+         (a.styleIndex() == b.styleIndex());
+}
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  ScreenWriter writer;
+  uint8_t image[512];
+
+  {
+    Widget root;
+    Widget panel(&root);
+    panel.moveTo(Point(5, 6));
+    panel.setSize(100, 50);
+    panel.setTransparent();
+    Label title("Title", &panel);
+    title.moveTo(Point(2, 2));
+    title.setSize(96, 12);
+    title.setAlignment(Label::center);
+    Button ok("OK", &root);
+    ok.moveTo(Point(10, 70));
+    ok.setSize(40, 20);
+
+    const size_t size = writer.write(root, image, sizeof(image));
+    CHECK(size != 0);
+    root.hide(); // the loaded tree becomes the top root
+
+    alignas(Button) uint8_t pool[1024];
+    CHECK(Screen::poolSize(image, size) <= sizeof(pool));
+    Screen screen;
+    Widget* loaded = screen.load(image, size, pool, sizeof(pool));
+    CHECK(loaded != nullptr);
+    CHECK(screen.count() == 4);
+    if(screen.count() == 4)
+    {
+      CHECK(sameWidget(*screen.widget(1), panel));
+      CHECK(sameWidget(*screen.widget(2), title));
+      CHECK(sameWidget(*screen.widget(3), ok));
+      const Label* t = static_cast<const Label*>(screen.widget(2));
+      CHECK(strcmp(t->text(), "Title") == 0);
+      CHECK(t->alignment() == Label::center);
+      CHECK(screen.widget(2)->parent() == screen.widget(1));
+    }
+    screen.unload();
+    CHECK(Widget::checkRoots());
+  }
+
+  {
+    // a derived class must not be written as its base class
+    Widget root;
+    Label plain("plain", &root);
+    Clock clock(&root);
+    CHECK(clock.classId() == Widget::eClassLabel);
+    CHECK(writer.write(root, image, sizeof(image)) == 0);
+    // nor anywhere deeper in the tree
+    Widget other;
+    Widget panel(&other);
+    Clock nested(&panel);
+    CHECK(writer.write(other, image, sizeof(image)) == 0);
+    CHECK(writer.write(panel, image, sizeof(image)) == 0);
+  }
+
+  {
+    // classes without a screen format class id
+    Widget root;
+    ProgressBar bar(&root);
+    CHECK(writer.write(root, image, sizeof(image)) == 0);
+  }
+
+  return checkResult("screenTest");
+}
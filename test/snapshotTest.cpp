@@ -0,0 +1,200 @@
+/* Renders Widget, Label and Button scenes into a pixmap and compares them
+  against the reference images in the golden directory. Incremental frames
+  (focus changes, partial label updates) are compared too, so they must come
+  out exactly like the reference. A few pixels of every scene are checked
+  against hand-computed colors, so a wrong reference can't slip in with
+  --update. The widgets scene is also recorded to write its overdraw heatmap
+  (outDir/widgets-overdraw.ppm) and check some of its counts.
+
+  usage: snapshotTest [--update] [goldenDir [outDir]]
+  --update writes the references instead of comparing, differing frames are
+  written to outDir as <scene>-diff.ppm.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "check.h"
+#include "snapshot.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static bool update = false;
+static const char* goldenDir = "golden";
+static const char* outDir = "build";
+
+static void snapshot(GDisplay* g, const char* scene)
+{
+  char reference[256];
+  char diff[256];
+  snprintf(reference, sizeof(reference), "%s/%s.ppm", goldenDir, scene);
+  snprintf(diff, sizeof(diff), "%s/%s-diff.ppm", outDir, scene);
+  if(update)
+  {
+    CHECK(Snapshot::save(g, reference));
+    return;
+  }
+  const long differences = Snapshot::compare(g, reference, diff);
+  if(differences != 0)
+  {
+    fprintf(stderr, "%s: %ld differing pixels (-1: no reference), see %s\n",
+            scene, differences, diff);
+  }
+  CHECK(differences == 0);
+}
+
+// colors by hand, from the default style in Widget::init() and the host font
+static void expectPixel(GDisplay* g, Coordinate x, Coordinate y, color_t expected,
+                        const char* scene)
+{
+  const color_t c = gdispGGetPixelColor(g, x, y);
+  if(c != expected)
+  {
+    fprintf(stderr, "%s: pixel %d,%d is %04x, expected %04x\n", scene, x, y, c, expected);
+  }
+  CHECK(c == expected);
+}
+
+static void widgets(GDisplay* g)
+{
+  Widget root;
+  root.setDisplay(g);
+  Widget panel(&root);
+  panel.moveTo(Point(10, 10));
+  panel.setSize(60, 40);
+  Widget inner(&panel);
+  inner.moveTo(Point(5, 5));
+  inner.setSize(20, 15);
+  Widget group(&root);
+  group.setTransparent();
+  group.moveTo(Point(80, 10));
+  group.setSize(60, 40);
+  Widget child(&group);
+  child.moveTo(Point(10, 10));
+  child.setSize(30, 20);
+  Widget highlighted(&root);
+  highlighted.moveTo(Point(10, 70));
+  highlighted.setSize(140, 30);
+  highlighted.setAcceptsFocus(true);
+  root.giveFocus();
+  Widget::drawWidgets(g);
+  expectPixel(g, 0, 0, White, "widgets");      // root border
+  expectPixel(g, 5, 5, Gray, "widgets");       // root fill
+  expectPixel(g, 15, 15, White, "widgets");    // inner border
+  expectPixel(g, 80, 10, Gray, "widgets");     // transparent group: root fill
+  expectPixel(g, 90, 20, White, "widgets");    // child border
+  expectPixel(g, 10, 70, Orange, "widgets");   // focused border
+  expectPixel(g, 11, 71, Gray, "widgets");     // focused fill
+  snapshot(g, "widgets");
+
+  // overdraw of a full redraw: every opaque widget fills its area once
+  StaticDrawList<64> list;
+  root.redraw();
+  Widget::recordWidgets(g, list);
+  CHECK(list.complete());
+  OverdrawMap overdraw(gdispGGetWidth(g), gdispGGetHeight(g));
+  overdraw.add(list);
+  char path[256];
+  snprintf(path, sizeof(path), "%s/widgets-overdraw.ppm", outDir);
+  CHECK(overdraw.save(path));
+  CHECK(overdraw.count(0, 0) == 1);   // root border
+  CHECK(overdraw.count(5, 5) == 1);   // root fill
+  CHECK(overdraw.count(40, 30) == 2); // root and panel
+  CHECK(overdraw.count(20, 20) == 3); // root, panel and inner
+  CHECK(overdraw.count(85, 12) == 1); // the transparent group draws nothing
+  CHECK(overdraw.count(100, 25) == 2); // root and child
+  CHECK(overdraw.max() == 3);
+}
+
+static void labels(GDisplay* g)
+{
+  Widget root;
+  root.setDisplay(g);
+  Label left("left", &root);
+  left.moveTo(Point(10, 10));
+  left.setSize(140, 16);
+  Label center("center", &root);
+  center.moveTo(Point(10, 30));
+  center.setSize(140, 16);
+  center.setAlignment(Label::center);
+  Label right("right", &root);
+  right.moveTo(Point(10, 50));
+  right.setSize(140, 16);
+  right.setAlignment(Label::right);
+  Label clipped("this text is too long for the label", &root);
+  clipped.moveTo(Point(10, 70));
+  clipped.setSize(80, 16);
+  Label counter("0000", &root);
+  counter.moveTo(Point(10, 90));
+  counter.setSize(60, 16);
+  counter.setPartialUpdate(true);
+  Widget::drawWidgets(g);
+  // "left" starts at the label's left edge, 3 pixels down, 'l' has row 1
+  // pixels in columns 1 and 4
+  expectPixel(g, 11, 14, White, "labels");
+  expectPixel(g, 12, 14, Gray, "labels");
+  expectPixel(g, 92, 75, Gray, "labels"); // clipped text ends at the label
+  expectPixel(g, 23, 94, Gray, "labels"); // '0' has no pixel there
+  snapshot(g, "labels");
+
+  counter.setText("0042");
+  Widget::drawWidgets(g);
+  expectPixel(g, 23, 94, White, "labels-update"); // but '4' has
+  expectPixel(g, 22, 94, Gray, "labels-update");
+  snapshot(g, "labels-update");
+}
+
+static void buttons(GDisplay* g)
+{
+  Widget root;
+  root.setDisplay(g);
+  Button ok("OK", &root);
+  ok.moveTo(Point(10, 10));
+  ok.setSize(60, 20);
+  Button cancel("Cancel", &root);
+  cancel.moveTo(Point(80, 10));
+  cancel.setSize(70, 20);
+  Button wide("Settings", &root);
+  wide.moveTo(Point(10, 40));
+  wide.setSize(140, 24);
+  wide.setAlignment(Label::left);
+  root.giveFocus();
+  Widget::drawWidgets(g);
+  expectPixel(g, 10, 10, Orange, "buttons"); // ok has the focus
+  expectPixel(g, 80, 10, White, "buttons");
+  snapshot(g, "buttons");
+
+  root.focusNextChild();
+  Widget::drawWidgets(g);
+  expectPixel(g, 10, 10, White, "buttons-focus");
+  expectPixel(g, 80, 10, Orange, "buttons-focus");
+  snapshot(g, "buttons-focus");
+}
+
+int main(int argc, char** argv)
+{
+  int i = 1;
+  if((i < argc) && (strcmp(argv[i], "--update") == 0))
+  {
+    update = true;
+    i++;
+  }
+  if(i < argc)
+  {
+    goldenDir = argv[i++];
+  }
+  if(i < argc)
+  {
+    outDir = argv[i++];
+  }
+
+  gfxInit();
+  Widget::init();
+  GDisplay* g = gdispPixmapCreate(160, 120);
+  widgets(g);
+  labels(g);
+  buttons(g);
+  gdispPixmapDelete(g);
+  return checkResult("snapshotTest");
+}
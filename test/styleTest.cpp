@@ -0,0 +1,148 @@
+/* Switching palette entries redraws only the widgets whose style uses them,
+  with the new colors. A full StyleTable makes interning a new style fail
+  instead of handing out the default style, and widgets keep their current
+  style then.
+*/
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static Style makeStyle(Color background)
+{
+  Style s = Widget::defaultStyle();
+  s.background = background;
+  return s;
+}
+
+static const PaletteIndex eAccent = ePaletteYellow + 1;
+static const PaletteIndex eWarning = ePaletteYellow + 2;
+
+static pixel_t pixel(GDisplay* g, Coordinate x, Coordinate y)
+{
+  return gdispPixmapGetBits(g)[y * gdispGGetWidth(g) + x];
+}
+
+// the default style with another fill for active widgets
+static StyleSpec filledWith(PaletteIndex fill)
+{
+  StyleSpec s = {ePaletteBlack,
+                 {ePaletteBlack, ePaletteGray, ePaletteGray},
+                 {fill, ePaletteWhite, ePaletteWhite},
+                 {ePaletteGray, ePaletteWhite, ePaletteOrange},
+                 {ePaletteYellow, ePaletteWhite, ePaletteWhite},
+                 FontRegistry::defaultId};
+  return s;
+}
+
+static void paletteSwitch()
+{
+  const Color accents[] = {Blue, Red};
+  Widget::setPalette(accents, 2, eAccent);
+  GDisplay* g = gdispPixmapCreate(100, 60);
+  // the root and what inherits from it keep their colors
+  Widget root;
+  root.setDisplay(g);
+  CHECK(root.setStyle(Widget::defaultStyle()));
+  Widget accent(&root);
+  accent.moveTo(Point(10, 10));
+  accent.setSize(30, 20);
+  CHECK(accent.setStyle(filledWith(eAccent)));
+  Widget inheriting(&accent); // follows accent's style
+  inheriting.moveTo(Point(5, 5));
+  inheriting.setSize(10, 10);
+  Widget warning(&root);
+  warning.moveTo(Point(50, 10));
+  warning.setSize(30, 20);
+  CHECK(warning.setStyle(filledWith(eWarning)));
+  Widget plain(&root);
+  plain.moveTo(Point(10, 35));
+  plain.setSize(30, 20);
+  plain.setStyle(StyleTable::defaultIndex); // the paletted default
+  Widget fixed(&root); // inherits the root's native style
+  fixed.moveTo(Point(50, 35));
+  fixed.setSize(30, 20);
+  Widget::drawWidgets(g);
+  CHECK(pixel(g, 12, 12) == Blue);
+  CHECK(pixel(g, 52, 12) == Red);
+  CHECK(pixel(g, 12, 37) == Gray);
+  CHECK(pixel(g, 52, 37) == Gray);
+
+  // the accent: that widget, which redraws the one inheriting its style too
+  const Color newAccent = Yellow;
+  Widget::setPalette(&newAccent, 1, eAccent);
+  CHECK(accent.needsDrawing());
+  CHECK(!warning.needsDrawing() && !plain.needsDrawing() && !fixed.needsDrawing());
+  // box and fill for both
+  CHECK(Widget::drawWidgets(g).primitives == 4);
+  CHECK(pixel(g, 12, 12) == Yellow);
+  CHECK(pixel(g, 17, 17) == Yellow);
+  CHECK(pixel(g, 52, 12) == Red);
+
+  // the same color again: nothing
+  Widget::setPalette(&newAccent, 1, eAccent);
+  CHECK(!root.needsDrawing());
+
+  // an entry no style uses: nothing
+  const Color unused = Red;
+  Widget::setPalette(&unused, 1, eWarning + 1);
+  CHECK(!root.needsDrawing());
+
+  // gray is in every paletted style, but not in the native one
+  const Color newGray = Blue;
+  Widget::setPalette(&newGray, 1, ePaletteGray);
+  CHECK(accent.needsDrawing() && warning.needsDrawing() && plain.needsDrawing());
+  CHECK(!fixed.needsDrawing());
+  // box and fill for 4 widgets
+  CHECK(Widget::drawWidgets(g).primitives == 8);
+  CHECK(pixel(g, 12, 37) == Blue);
+  CHECK(pixel(g, 52, 37) == Gray);
+  CHECK(pixel(g, 95, 55) == Gray);
+  // back to the colors of the rest of the test
+  const Color oldGray = Gray;
+  Widget::setPalette(&oldGray, 1, ePaletteGray);
+
+  gdispPixmapDelete(g);
+}
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  paletteSwitch();
+
+  Widget root;
+  Widget w(&root);
+
+  const Style first = makeStyle(1);
+  CHECK(w.setStyle(first));
+  const StyleIndex firstIndex = w.styleIndex();
+  CHECK(firstIndex != StyleTable::defaultIndex);
+  CHECK(StyleTable::intern(first) == firstIndex);
+
+  // fill the table
+  Color c = 2;
+  while(StyleTable::count() < UWDG_STYLES)
+  {
+    CHECK(StyleTable::intern(makeStyle(c++)) != StyleTable::invalid);
+  }
+  CHECK(StyleTable::intern(makeStyle(c)) == StyleTable::invalid);
+  StyleSpec spec = {ePaletteWhite, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, 0};
+  CHECK(StyleTable::intern(spec) == StyleTable::invalid);
+
+  // known styles are still found
+  CHECK(StyleTable::intern(first) == firstIndex);
+
+  // a failed setStyle() keeps the current style and doesn't redraw
+  Widget::drawWidgets();
+  CHECK(!w.setStyle(makeStyle(c)));
+  CHECK(!w.setStyle(spec));
+  CHECK(w.styleIndex() == firstIndex);
+  CHECK(w.style() == first);
+  CHECK(!root.needsDrawing());
+  w.setStyle(StyleTable::invalid);
+  CHECK(w.styleIndex() == firstIndex);
+
+  return checkResult("styleTest");
+}
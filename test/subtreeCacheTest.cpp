@@ -0,0 +1,177 @@
+/* SubtreeCache entries must survive the pass that uses them: nested cached
+  widgets must not evict the pixmap their ancestor renders into, a recorded
+  blit must stay valid until the list is replayed, and passes for different
+  displays may run in different threads.
+*/
+
+#include <thread>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static bool samePixels(GDisplay* a, GDisplay* b)
+{
+  const pixel_t* pa = gdispPixmapGetBits(a);
+  const pixel_t* pb = gdispPixmapGetBits(b);
+  for(size_t i = 0; i < (size_t)gdispGGetWidth(a) * gdispGGetHeight(a); i++)
+  {
+    if(pa[i] != pb[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static size_t bytesOf(Length w, Length h)
+{
+  return (size_t)w * h * sizeof(pixel_t);
+}
+
+// a root with two cached panels of 40x30 holding a label each
+class Scene
+{
+public:
+  Scene(GDisplay* g) :
+    left_(&root_),
+    right_(&root_),
+    leftText_("left", &left_),
+    rightText_("right", &right_)
+  {
+    root_.setDisplay(g);
+    left_.moveTo(Point(5, 5));
+    left_.setSize(40, 30);
+    right_.moveTo(Point(50, 5));
+    right_.setSize(40, 30);
+    leftText_.moveTo(Point(2, 2));
+    leftText_.setSize(36, 12);
+    rightText_.moveTo(Point(2, 16));
+    rightText_.setSize(36, 12);
+  }
+
+  void setCached(bool b)
+  {
+    left_.setCached(b);
+    right_.setCached(b);
+  }
+
+  void setText(const char* s)
+  {
+    leftText_.setText(s);
+    rightText_.setText(s);
+  }
+
+  Widget root_;
+  Widget left_;
+  Widget right_;
+  Label leftText_;
+  Label rightText_;
+};
+
+int main()
+{
+  gfxInit();
+  Widget::init();
+  SubtreeCache& cache = SubtreeCache::instance();
+  GDisplay* reference = gdispPixmapCreate(100, 40);
+  GDisplay* g = gdispPixmapCreate(100, 40);
+
+  {
+    // recording two cached panels with room for one: the second can't evict
+    // the first, whose blit is already in the list, and is drawn directly
+    cache.setBudget(bytesOf(40, 30));
+    Scene scene(reference);
+    Widget::drawWidgets(reference);
+    scene.root_.setDisplay(g);
+    scene.setCached(true);
+    StaticDrawList<256> list;
+    Widget::recordWidgets(g, list);
+    CHECK(list.pins().subtrees != 0);
+    CHECK(cache.bytes() <= cache.budget());
+    list.replay();
+    list.clear();
+    CHECK(samePixels(reference, g));
+
+    // later frames take turns
+    scene.setText("again");
+    Widget::recordWidgets(g, list);
+    list.replay();
+    list.clear();
+    scene.root_.setDisplay(reference);
+    scene.setCached(false);
+    Widget::drawWidgets(reference);
+    CHECK(samePixels(reference, g));
+    scene.root_.hide();
+  }
+
+  {
+    // a cached widget inside a cached widget, with room for only one pixmap
+    cache.setBudget(bytesOf(90, 30));
+    Widget root;
+    root.setDisplay(reference);
+    Widget outer(&root);
+    outer.moveTo(Point(5, 5));
+    outer.setSize(90, 30);
+    Widget inner(&outer);
+    inner.moveTo(Point(5, 5));
+    inner.setSize(40, 20);
+    Label text("nested", &inner);
+    text.setSize(40, 20);
+    Widget::drawWidgets(reference);
+    root.setDisplay(g);
+    outer.setCached(true);
+    inner.setCached(true);
+    Widget::drawWidgets(g);
+    CHECK(samePixels(reference, g));
+    text.setText("changed");
+    Widget::drawWidgets(g);
+    root.setDisplay(reference);
+    outer.setCached(false);
+    inner.setCached(false);
+    Widget::drawWidgets(reference);
+    CHECK(samePixels(reference, g));
+    // the root is destroyed while the next scene's roots are created
+  }
+
+  {
+    // displays drawn from two threads share the cache
+    cache.setBudget(3 * bytesOf(40, 30));
+    GDisplay* other = gdispPixmapCreate(100, 40);
+    Scene a(g);
+    Scene b(other);
+    a.setCached(true);
+    b.setCached(true);
+    std::thread t([&b, other]
+    {
+      char s[16];
+      for(int i = 0; i < 500; i++)
+      {
+        snprintf(s, sizeof(s), "%d", i);
+        b.setText(s);
+        Widget::drawWidgets(other);
+      }
+    });
+    char s[16];
+    for(int i = 0; i < 500; i++)
+    {
+      snprintf(s, sizeof(s), "%d", i);
+      a.setText(s);
+      Widget::drawWidgets(g);
+    }
+    t.join();
+    CHECK(cache.bytes() <= cache.budget());
+    CHECK(samePixels(g, other));
+    a.root_.hide();
+    b.root_.hide();
+    a.setCached(false);
+    b.setCached(false);
+    gdispPixmapDelete(other);
+  }
+
+  CHECK(cache.bytes() == 0);
+  gdispPixmapDelete(reference);
+  gdispPixmapDelete(g);
+  return checkResult("subtreeCacheTest");
+}
@@ -0,0 +1,169 @@
+/* Measures the speedup of TileRenderer over 1..N threads on a dashboard
+  sized frame and checks that every thread count produces exactly the pixels
+  of a direct, single threaded pass.
+
+  usage: tileBench [maxThreads [frames]]
+  maxThreads defaults to the number of hardware threads, frames to 20.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "tileRenderer.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+static const Length displayWidth = 1280;
+static const Length displayHeight = 720;
+
+// a grid of panels with a title, a gauge and a progress bar each
+class Dashboard
+{
+public:
+  Dashboard(GDisplay* g)
+  {
+    root_.setDisplay(g);
+    const Length w = 160;
+    const Length h = 120;
+    for(Coordinate y = 0; y + h <= displayHeight; y += h)
+    {
+      for(Coordinate x = 0; x + w <= displayWidth; x += w)
+      {
+        Widget* panel = new Widget(&root_);
+        panel->moveTo(Point(x, y));
+        panel->setSize(w - 4, h - 4);
+        Label* title = new Label("channel", panel);
+        title->moveTo(Point(4, 4));
+        title->setSize(w - 12, 14);
+        Gauge* gauge = new Gauge(panel);
+        gauge->moveTo(Point(4, 20));
+        gauge->setSize(70, 70);
+        gauge->setRange(0, 100);
+        ProgressBar* bar = new ProgressBar(panel);
+        bar->moveTo(Point(4, 96));
+        bar->setSize(w - 12, 14);
+        bar->setRange(0, 100);
+        widgets_.push_back(title);
+        widgets_.push_back(gauge);
+        widgets_.push_back(bar);
+        widgets_.push_back(panel);
+        values_.push_back(gauge);
+        values_.push_back(bar);
+      }
+    }
+  }
+
+  ~Dashboard()
+  {
+    for(Widget* w : widgets_)
+    {
+      delete w;
+    }
+  }
+
+  // a frame where everything changes
+  void update(int frame)
+  {
+    for(size_t i = 0; i < values_.size(); i++)
+    {
+      values_[i]->setValue((frame * 7 + i * 13) % 101);
+    }
+    root_.redraw();
+  }
+
+  Widget root_;
+
+private:
+  std::vector<Widget*> widgets_;
+  std::vector<ValueWidget*> values_;
+};
+
+static bool samePixels(GDisplay* a, GDisplay* b)
+{
+  const pixel_t* pa = gdispPixmapGetBits(a);
+  const pixel_t* pb = gdispPixmapGetBits(b);
+  for(size_t i = 0; i < (size_t)displayWidth * displayHeight; i++)
+  {
+    if(pa[i] != pb[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static double milliseconds(std::chrono::steady_clock::duration d)
+{
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+int main(int argc, char** argv)
+{
+  unsigned maxThreads = std::thread::hardware_concurrency();
+  int frames = 20;
+  if(argc > 1)
+  {
+    maxThreads = atoi(argv[1]);
+  }
+  if(argc > 2)
+  {
+    frames = atoi(argv[2]);
+  }
+  maxThreads = maxThreads > 0 ? maxThreads : 1;
+  frames = frames > 0 ? frames : 1;
+
+  gfxInit();
+  Widget::init();
+  GDisplay* reference = gdispPixmapCreate(displayWidth, displayHeight);
+  GDisplay* target = gdispPixmapCreate(displayWidth, displayHeight);
+  Dashboard dashboard(reference);
+
+  // direct, single threaded
+  std::chrono::steady_clock::duration direct(0);
+  for(int f = 0; f < frames; f++)
+  {
+    dashboard.update(f);
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    Widget::drawWidgets(reference);
+    direct += std::chrono::steady_clock::now() - begin;
+  }
+  const double directMs = milliseconds(direct) / frames;
+  printf("%ux%u, %d frames, %u hardware threads\n", displayWidth, displayHeight, frames,
+         std::thread::hardware_concurrency());
+  printf("direct      %8.2f ms/frame\n", directMs);
+
+  dashboard.root_.setDisplay(target);
+  double oneThreadMs = 0;
+  for(unsigned n = 1; n <= maxThreads; n++)
+  {
+    TileRenderer renderer(target, n);
+    std::chrono::steady_clock::duration total(0);
+    size_t steals = 0;
+    for(int f = 0; f < frames; f++)
+    {
+      dashboard.update(f);
+      const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+      renderer.drawWidgets();
+      total += std::chrono::steady_clock::now() - begin;
+      steals += renderer.steals();
+    }
+    const double ms = milliseconds(total) / frames;
+    oneThreadMs = (n == 1) ? ms : oneThreadMs;
+    const bool same = samePixels(reference, target);
+    CHECK(same);
+    printf("%2u threads  %8.2f ms/frame  speedup %5.2f (direct %5.2f)  %4zu tiles  %4zu steals%s\n",
+           n, ms, oneThreadMs / ms, directMs / ms, renderer.tiles(), steals / frames,
+           same ? "" : "  DIFFERENT PIXELS");
+  }
+
+  dashboard.root_.setDisplay(reference);
+  gdispPixmapDelete(target);
+  gdispPixmapDelete(reference);
+  return checkResult("tileBench");
+}
@@ -0,0 +1,383 @@
+/* Randomized stress test and scaling benchmark for tree mutation, focus,
+  input dispatch and drawing. For each tree size, builds a random tree of
+  containers and buttons (mixing wide and deep branches), then runs random
+  sequences of adds, removals of whole subtrees, moves, focus changes, root
+  changes, input events, passes and idle frames around that size. The root
+  list and all trees are checked after every step, and so is the focus,
+  which must be nullptr or a live widget. Idle frames must draw nothing.
+
+  Prints the latency percentiles of every operation per tree size. Only the
+  calls into uwdg are timed, not picking widgets and bookkeeping.
+
+  usage: treeStress [steps [seed]]
+  steps per tree size defaults to 20000, seed to 1.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "check.h"
+#include "uwdg-simple.h"
+
+using namespace uwdg;
+
+enum Operation
+{
+  opAdd,
+  opRemove,
+  opMove,
+  opFocus,
+  opFocusNext,
+  opEvent,
+  opRoot,
+  opDraw,
+  opIdle,
+  numOperations
+};
+
+static const char* const operationNames[numOperations] = {
+  "add", "remove", "move", "focus", "focusNext", "event", "root", "draw", "idle"
+};
+
+// widgets a removal deletes at most, so the size stays around its target
+static const size_t maxRemoved = 64;
+
+class Stress
+{
+public:
+  Stress(unsigned seed) :
+    random_(seed),
+    other_(nullptr),
+    otherButton_(nullptr),
+    idleValid_(true)
+  {
+    Widget::raiseRoot(&root_);
+  }
+
+  ~Stress()
+  {
+    while(!widgets_.empty())
+    {
+      remove();
+    }
+    if(other_ != nullptr)
+    {
+      toggleRoot();
+    }
+  }
+
+  size_t size() const
+  {
+    return widgets_.size();
+  }
+
+  void add()
+  {
+    // every 8th widget goes below the newest container, which makes deep branches
+    Widget* parent = &root_;
+    if(!containers_.empty())
+    {
+      parent = (pick(8) == 0) ? containers_.back() : containers_[pick(containers_.size())];
+    }
+    const bool button = pick(3) == 0;
+    start();
+    Widget* w = button ? new Button("b", parent) : new Widget(parent);
+    w->setSize(20, 10);
+    stop();
+    if(!button)
+    {
+      containers_.push_back(w);
+    }
+    index_[w] = widgets_.size();
+    widgets_.push_back(w);
+  }
+
+  /* deletes the subtree of a random widget, children first. Large subtrees
+    are replaced by the one of their last child until it's small enough.
+  */
+  void remove()
+  {
+    Widget* w = widgets_[pick(widgets_.size())];
+    std::vector<Widget*> subtree;
+    collect(w, subtree);
+    while(subtree.size() > maxRemoved)
+    {
+      w = lastChild(w);
+      subtree.clear();
+      collect(w, subtree);
+    }
+    start();
+    for(Widget* d : subtree)
+    {
+      delete d;
+    }
+    stop();
+    for(Widget* d : subtree)
+    {
+      forget(d);
+    }
+  }
+
+  void move()
+  {
+    Widget* w = widgets_[pick(widgets_.size())];
+    const Point p(pick(200), pick(100));
+    start();
+    w->moveTo(p);
+    stop();
+  }
+
+  void focus()
+  {
+    Widget* w = widgets_[pick(widgets_.size())];
+    start();
+    w->giveFocus();
+    stop();
+  }
+
+  void focusNext()
+  {
+    Widget* f = Widget::focus();
+    if((f == nullptr) || !f->hasParent())
+    {
+      return;
+    }
+    const bool forward = pick(2) == 0;
+    start();
+    if(forward)
+    {
+      f->parent()->focusNextChild();
+    }
+    else
+    {
+      f->parent()->focusPrevChild();
+    }
+    stop();
+  }
+
+  void event()
+  {
+    static const InputEvent::EInputType types[] = {
+      InputEvent::eLeft, InputEvent::eUp, InputEvent::eRight, InputEvent::eDown,
+      InputEvent::eEnter, InputEvent::eCW, InputEvent::eCCW
+    };
+    InputEvent e(types[pick(sizeof(types) / sizeof(types[0]))], pick(4) != 0);
+    start();
+    Widget::dispatchInputEvent(e);
+    stop();
+  }
+
+  // adds a second root with a button on top, or deletes it
+  void toggleRoot()
+  {
+    start();
+    if(other_ == nullptr)
+    {
+      other_ = new Widget;
+      otherButton_ = new Button("other", other_);
+      Widget::raiseRoot(other_);
+    }
+    else
+    {
+      delete otherButton_;
+      delete other_;
+      other_ = nullptr;
+    }
+    stop();
+  }
+
+  // a pass for the changes since the last one
+  void draw()
+  {
+    start();
+    Widget::drawWidgets(GDISP);
+    stop();
+  }
+
+  // a pass after one that left nothing to draw
+  void idle()
+  {
+    Widget::drawWidgets(GDISP);
+    start();
+    const RenderContext::Stats s = Widget::drawWidgets(GDISP);
+    stop();
+    idleValid_ = idleValid_ && (s.primitives == 0);
+  }
+
+  // runs op and returns the time spent in uwdg
+  std::chrono::steady_clock::duration run(Operation op)
+  {
+    elapsed_ = std::chrono::steady_clock::duration(0);
+    switch(op)
+    {
+      case opAdd: add(); break;
+      case opRemove: remove(); break;
+      case opMove: move(); break;
+      case opFocus: focus(); break;
+      case opFocusNext: focusNext(); break;
+      case opEvent: event(); break;
+      case opRoot: toggleRoot(); break;
+      case opDraw: draw(); break;
+      case opIdle: idle(); break;
+      default: break;
+    }
+    return elapsed_;
+  }
+
+  // keeps the size around target, everything else is equally likely
+  Operation nextOperation(size_t target)
+  {
+    const Operation op = static_cast<Operation>(pick(numOperations));
+    if(op == opAdd)
+    {
+      return (widgets_.size() > target) ? opRemove : opAdd;
+    }
+    if((op == opRemove) && (widgets_.size() < target))
+    {
+      return opAdd;
+    }
+    return op;
+  }
+
+  bool focusValid() const
+  {
+    Widget* f = Widget::focus();
+    return (f == nullptr) || (f == &root_) || (index_.count(f) != 0) ||
+           ((other_ != nullptr) && ((f == other_) || (f == otherButton_)));
+  }
+
+  bool idleValid() const
+  {
+    return idleValid_;
+  }
+
+private:
+  void start()
+  {
+    begin_ = std::chrono::steady_clock::now();
+  }
+
+  void stop()
+  {
+    elapsed_ += std::chrono::steady_clock::now() - begin_;
+  }
+
+  size_t pick(size_t n)
+  {
+    return std::uniform_int_distribution<size_t>(0, n - 1)(random_);
+  }
+
+  static Widget* lastChild(Widget* w)
+  {
+    Widget* c = w->children();
+    while(c->next() != nullptr)
+    {
+      c = c->next();
+    }
+    return c;
+  }
+
+  // w's subtree, children before their parents
+  static void collect(Widget* w, std::vector<Widget*>& subtree)
+  {
+    for(Widget* c = w->children(); c != nullptr; c = c->next())
+    {
+      collect(c, subtree);
+    }
+    subtree.push_back(w);
+  }
+
+  void forget(Widget* w)
+  {
+    const size_t i = index_[w];
+    widgets_[i] = widgets_.back();
+    index_[widgets_[i]] = i;
+    widgets_.pop_back();
+    index_.erase(w);
+    std::vector<Widget*>::iterator c = std::find(containers_.begin(), containers_.end(), w);
+    if(c != containers_.end())
+    {
+      containers_.erase(c);
+    }
+  }
+
+  std::mt19937 random_;
+  Widget root_;
+  std::vector<Widget*> widgets_;
+  std::vector<Widget*> containers_;
+  std::unordered_map<Widget*, size_t> index_;
+  Widget* other_;
+  Widget* otherButton_;
+  bool idleValid_;
+  std::chrono::steady_clock::time_point begin_;
+  std::chrono::steady_clock::duration elapsed_;
+};
+
+static void printPercentiles(size_t size, Operation op, std::vector<uint32_t>& ns)
+{
+  if(ns.empty())
+  {
+    return;
+  }
+  std::sort(ns.begin(), ns.end());
+  const size_t n = ns.size();
+  printf("%6zu  %-10s %7zu %8u %8u %8u %8u\n", size, operationNames[op], n,
+         ns[n / 2], ns[n * 9 / 10], ns[n * 99 / 100], ns[n - 1]);
+}
+
+int main(int argc, char** argv)
+{
+  long steps = 20000;
+  unsigned seed = 1;
+  if(argc > 1)
+  {
+    steps = atol(argv[1]);
+  }
+  if(argc > 2)
+  {
+    seed = atoi(argv[2]);
+  }
+
+  gfxInit();
+  Widget::init();
+
+  static const size_t sizes[] = {256, 1024, 4096};
+  printf("%ld steps per size, seed %u, latencies in ns\n", steps, seed);
+  printf("  size  operation    count      p50      p90      p99      max\n");
+  for(size_t size : sizes)
+  {
+    Stress stress(seed);
+    while(stress.size() < size)
+    {
+      stress.add();
+    }
+    CHECK(Widget::checkRoots());
+
+    std::vector<uint32_t> latencies[numOperations];
+    for(long step = 0; step < steps; step++)
+    {
+      const Operation op = stress.nextOperation(size);
+      const std::chrono::steady_clock::duration d = stress.run(op);
+      latencies[op].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+      if(!Widget::checkRoots() || !stress.focusValid() || !stress.idleValid())
+      {
+        fprintf(stderr, "size %zu, step %ld (%s), seed %u: broken tree, focus or idle frame\n",
+                size, step, operationNames[op], seed);
+        CHECK(false);
+        break;
+      }
+    }
+    for(int op = 0; op < numOperations; op++)
+    {
+      printPercentiles(size, static_cast<Operation>(op), latencies[op]);
+    }
+  }
+  CHECK(Widget::checkRoots());
+  return checkResult("treeStress");
+}
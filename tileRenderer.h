@@ -0,0 +1,257 @@
+#ifndef UWDG_TILERENDERER_H
+#define UWDG_TILERENDERER_H
+
+/* Parallel rasterization of frames for hosts with large displays.
+
+  A TileRenderer draws the widgets of a pixmap display (GDISP_NEED_PIXMAP),
+  e.g. the back buffer of a framebuffer on a Linux panel PC. The frame is
+  recorded into a DrawList first, which walks the widget tree and clears its
+  flags on the calling thread only. The area the list touches is then cut
+  into tiles, which are rasterized in parallel: every worker owns a tile
+  sized pixmap with its own clip, copies the tile's current pixels in,
+  replays the part of the list inside the tile and copies the result back.
+  Tiles don't overlap, so the output is identical to a serial replay.
+
+  Tiles are handed out through per-worker deques; a worker that runs out
+  takes tiles from the back of the others' deques. The calling thread works
+  as worker 0.
+
+  Uses std::thread and is meant for hosts, not for targets.
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "drawList.h"
+#include "widget.h"
+
+namespace uwdg
+{
+
+#if GDISP_NEED_PIXMAP
+class TileRenderer
+{
+public:
+  // threads: number of workers including the calling thread
+  TileRenderer(GDisplay* target, unsigned threads = std::thread::hardware_concurrency(),
+               Length tileSize = 64, size_t commands = 4096) :
+    target_(target),
+    tileSize_(tileSize > 0 ? tileSize : 64),
+    commands_(commands),
+    list_(commands_.data(), commands_.size()),
+    frame_(nullptr),
+    workers_(threads > 0 ? threads : 1),
+    generation_(0),
+    remaining_(0),
+    tiles_(0),
+    steals_(0),
+    stop_(false)
+  {
+    for(Worker& w : workers_)
+    {
+      w.pixmap = gdispPixmapCreate(tileSize_, tileSize_);
+    }
+    for(size_t i = 1; i < workers_.size(); i++)
+    {
+      workers_[i].thread = std::thread(&TileRenderer::run, this, i);
+    }
+  }
+
+  ~TileRenderer()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    start_.notify_all();
+    for(Worker& w : workers_)
+    {
+      if(w.thread.joinable())
+      {
+        w.thread.join();
+      }
+      gdispPixmapDelete(w.pixmap);
+    }
+  }
+
+  unsigned threads() const
+  {
+    return workers_.size();
+  }
+
+  // tiles rasterized in the last frame
+  size_t tiles() const
+  {
+    return tiles_;
+  }
+
+  // tiles taken from another worker's deque in the last frame
+  size_t steals() const
+  {
+    return steals_;
+  }
+
+  // draws the changes of the target's top root, like Widget::drawWidgets(g)
+  void drawWidgets()
+  {
+    tiles_ = 0;
+    steals_ = 0;
+    Widget* root = Widget::topRoot(target_);
+    if((root == nullptr) || !root->needsDrawing())
+    {
+      return;
+    }
+    list_.clear();
+    Widget::recordWidgets(target_, list_);
+    rasterize(list_);
+    list_.clear(); // releases the cache entries the frame pinned
+  }
+
+  // replays list to the target in parallel tiles
+  void rasterize(const DrawList& list)
+  {
+    const Rectangle area = list.bounds() &
+      Rectangle(Point(0, 0), Size(gdispGGetWidth(target_), gdispGGetHeight(target_)));
+    if(area.empty())
+    {
+      return;
+    }
+    {
+      // the frame is published before any tile of it can be taken
+      std::lock_guard<std::mutex> lock(mutex_);
+      frame_ = &list;
+      size_t n = 0;
+      for(Coordinate y = area.p0.y; y < area.p0.y + area.size.h; y += tileSize_)
+      {
+        for(Coordinate x = area.p0.x; x < area.p0.x + area.size.w; x += tileSize_)
+        {
+          Rectangle tile = Rectangle(Point(x, y), Size(tileSize_, tileSize_)) & area;
+          Worker& w = workers_[n++ % workers_.size()];
+          std::lock_guard<std::mutex> dequeLock(w.mutex);
+          w.tiles.push_back(tile);
+        }
+      }
+      tiles_ = n;
+      remaining_ = n;
+      generation_++;
+    }
+    start_.notify_all();
+    work(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return remaining_ == 0; });
+  }
+
+private:
+  struct Worker
+  {
+    GDisplay* pixmap;
+    std::thread thread;
+    std::mutex mutex;
+    std::deque<Rectangle> tiles;
+  };
+
+  void run(size_t index)
+  {
+    unsigned long seen = 0;
+    for(;;)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        start_.wait(lock, [this, seen] { return stop_ || (generation_ != seen); });
+        if(stop_)
+        {
+          return;
+        }
+        seen = generation_;
+      }
+      work(index);
+    }
+  }
+
+  void work(size_t index)
+  {
+    Rectangle tile;
+    while(take(index, tile))
+    {
+      const DrawList* frame;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frame = frame_;
+      }
+      draw(*frame, workers_[index].pixmap, tile);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(--remaining_ == 0)
+      {
+        done_.notify_all();
+      }
+    }
+  }
+
+  // the front of the own deque, or the back of another one
+  bool take(size_t index, Rectangle& tile)
+  {
+    for(size_t i = 0; i < workers_.size(); i++)
+    {
+      Worker& w = workers_[(index + i) % workers_.size()];
+      std::lock_guard<std::mutex> lock(w.mutex);
+      if(!w.tiles.empty())
+      {
+        if(i == 0)
+        {
+          tile = w.tiles.front();
+          w.tiles.pop_front();
+        }
+        else
+        {
+          tile = w.tiles.back();
+          w.tiles.pop_back();
+          steals_++;
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void draw(const DrawList& frame, GDisplay* pixmap, const Rectangle& tile)
+  {
+    pixel_t* dst = gdispPixmapGetBits(target_);
+    pixel_t* src = gdispPixmapGetBits(pixmap);
+    const coord_t stride = gdispGGetWidth(target_);
+    const size_t line = tile.size.w * sizeof(pixel_t);
+    for(Coordinate y = 0; y < tile.size.h; y++)
+    {
+      memcpy(src + y * tileSize_, dst + (tile.p0.y + y) * stride + tile.p0.x, line);
+    }
+    frame.replay(pixmap, tile);
+    for(Coordinate y = 0; y < tile.size.h; y++)
+    {
+      memcpy(dst + (tile.p0.y + y) * stride + tile.p0.x, src + y * tileSize_, line);
+    }
+  }
+
+  GDisplay* target_;
+  const Length tileSize_;
+  std::vector<DrawList::Command> commands_;
+  DrawList list_;
+  const DrawList* frame_; // guarded by mutex_
+  std::vector<Worker> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  unsigned long generation_;
+  size_t remaining_;
+  size_t tiles_;
+  std::atomic<size_t> steals_;
+  bool stop_;
+};
+#endif // GDISP_NEED_PIXMAP
+
+} // namespace uwdg
+
+#endif // UWDG_TILERENDERER_H
@@ -2,9 +2,41 @@
 
 namespace uwdg
 {
-font_t Style::defaultFont = gdispOpenFont("UI2");
-Style Widget::defaultStyle_;
 Widget* Widget::rootWidgets_;
-Rectangle Widget::currentClippingRect_;
-Point Widget::currentDrawingOffset_;
+
+Widget::~Widget()
+{
+  PRINTDEBUG(("~Widget(%p)\n", this));
+  Animator::instance().cancel(this);
+#if GDISP_NEED_PIXMAP
+  setCached(false);
+#endif // GDISP_NEED_PIXMAP
+  bool hadFocus = hasFocus();
+  if(hasParent())
+  {
+    parent()->removeChild(this);
+    if(hadFocus)
+    {
+      parent()->giveFocus();
+    }
+  }
+  else
+  {
+    removeRoot(this);
+    Widget* root = topRoot(display());
+    if(root != nullptr)
+    {
+      root->redraw();
+//      if(hadFocus)
+//      {
+        root->giveFocus();
+//      }
+    }
+  }
+  // nothing took the focus over, don't leave it dangling
+  if(hasFocus())
+  {
+    getFocusP() = nullptr;
+  }
+}
 } // namespace uwdg
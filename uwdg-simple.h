@@ -2,8 +2,15 @@
 #define UWDG_H
 
 #include "widget.h"
+#include "animation.h"
 #include "label.h"
 #include "button.h"
+#include "gauge.h"
+#include "image.h"
+#include "inputFilter.h"
+#include "plot.h"
+#include "progressBar.h"
+#include "screen.h"
 
 #endif // UWDG_H
 
@@ -0,0 +1,90 @@
+#ifndef UWDG_VALUEWIDGET_H
+#define UWDG_VALUEWIDGET_H
+
+#include "delegate.h"
+#include "widget.h"
+
+namespace uwdg
+{
+
+/* Base for widgets that display a value within a range.
+
+  A value change only requests a partial update(), subclasses repaint the
+  difference to what they drew last in drawUpdate(). Range, style and size
+  changes redraw completely.
+*/
+class ValueWidget : public Widget
+{
+public:
+  typedef int16_t Value;
+
+  ValueWidget(Widget* parent = nullptr) :
+    Widget(parent),
+    min_(0),
+    max_(100),
+    value_(0)
+  {
+  }
+
+  virtual uint8_t classId() const override
+  {
+    return eClassOther;
+  }
+
+  Value value() const
+  {
+    return value_;
+  }
+
+  void setValue(Value v)
+  {
+    v = v < min_ ? min_ : (v > max_ ? max_ : v);
+    if(v != value_)
+    {
+      value_ = v;
+      update();
+      valueChanged(value_);
+    }
+  }
+
+  Value minimum() const
+  {
+    return min_;
+  }
+
+  Value maximum() const
+  {
+    return max_;
+  }
+
+  void setRange(Value min, Value max)
+  {
+    min_ = min;
+    max_ = max > min ? max : min + 1;
+    value_ = value_ < min_ ? min_ : (value_ > max_ ? max_ : value_);
+    redraw();
+  }
+
+  void onResize() override
+  {
+    redraw();
+  }
+
+  Signal<Value> valueChanged;
+
+protected:
+  // maps v linearly from the value range to 0..length
+  int32_t scale(Value v, int32_t length) const
+  {
+    return (static_cast<int32_t>(v - min_) * length) / (max_ - min_);
+  }
+
+private:
+  Value min_;
+  Value max_;
+  Value value_;
+};
+
+} // namespace uwdg
+
+#endif // UWDG_VALUEWIDGET_H
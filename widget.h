@@ -29,11 +29,15 @@
 
 #include <algorithm>
 
+#include "delegate.h"
 #include "geometry.h"
+#include "renderContext.h"
 #include "style.h"
+#include "subtreeCache.h"
 //#define DEBUG_UWDG
 #include "debug.h"
 #include "inputEvent.h"
+#include "latency.h"
 
 namespace uwdg
 {
@@ -52,14 +56,16 @@ public:
     lastChild_(nullptr),
     prev_(nullptr),
     next_(nullptr),
-    style_(parent != nullptr ? &parent->style() : &defaultStyle_),
     font_(DefaultFont),
-    flags_(flag_visible | flag_redraw)
+    display_(parent != nullptr ? parent->display() : GDISP),
+    flags_(flag_visible | flag_redraw),
+    styleIndex_(parent != nullptr ? StyleTable::inherit : StyleTable::defaultIndex)
   {
     PRINTDEBUG(("Widget(%p)\n", this));
     if(parent != nullptr)
     {
       parent->appendChild(this);
+      propagateDirty();
     }
     else
     {
@@ -68,31 +74,8 @@ public:
     }
   }
 
-  virtual ~Widget()
-  {
-    PRINTDEBUG(("~Widget(%p)\n", this));
-    bool hadFocus = hasFocus();
-    if(hasParent())
-    {
-      parent()->removeChild(this);
-      if(hadFocus)
-      {
-        parent()->giveFocus();
-      }
-    }
-    else
-    {
-      removeRoot(this);
-      if(rootWidgets_ != nullptr)
-      {
-        rootWidgets_->redraw();
-//        if(hadFocus)
-//        {
-          rootWidgets_->giveFocus();
-//        }
-      }
-    }
-  }
+  // defined in uwdg-simple.cpp, as it cancels the widget's animations
+  virtual ~Widget();
 
 
   /*****************************************************************************
@@ -120,7 +103,10 @@ public:
   {
     w->next_ = rootWidgets_;
     rootWidgets_ = w;
-    getFocusP() = nullptr; // TBD: this seems like a hack
+    if(focusLocks() == 0)
+    {
+      getFocusP() = nullptr; // TBD: this seems like a hack
+    }
   }
 
 
@@ -148,6 +134,64 @@ public:
     root->next_ = nullptr;
   }
 
+  // puts root on top of its display's roots and gives it the focus
+  static void raiseRoot(Widget* root)
+  {
+    removeRoot(root);
+    root->next_ = rootWidgets_;
+    rootWidgets_ = root;
+    root->redraw();
+    root->giveFocus();
+  }
+
+  // puts root below all other roots, without touching the focus
+  static void lowerRoot(Widget* root)
+  {
+    removeRoot(root);
+    root->next_ = nullptr;
+    Widget** tail = &rootWidgets_;
+    while(*tail != nullptr)
+    {
+      tail = &(*tail)->next_;
+    }
+    *tail = root;
+  }
+
+  // the root on top of the list for display g, i.e. the one that is drawn
+  static Widget* topRoot(GDisplay* g)
+  {
+    Widget* w = rootWidgets_;
+    while((w != nullptr) && (w->display() != g))
+    {
+      w = w->next();
+    }
+    return w;
+  }
+
+  /*****************************************************************************
+  * Display
+  *****************************************************************************/
+  GDisplay* display() const
+  {
+    if(hasParent())
+    {
+      return parent()->display();
+    }
+    return display_;
+  }
+
+  // moves a root widget (and its children) to another display
+  void setDisplay(GDisplay* g)
+  {
+    if(hasParent())
+    {
+      return; // children always use their root's display
+    }
+    display_ = g;
+    setSize(gdispGGetWidth(g), gdispGGetHeight(g));
+    redraw();
+  }
+
   /*****************************************************************************
   * Parent
   *****************************************************************************/
@@ -207,10 +251,57 @@ void removeChild(Widget* child)
   // update tail
   if(lastChild_ == child)
   {
-    lastChild_->next_ = nullptr;
+    lastChild_ = child->prev_;
   }
+  child->prev_ = nullptr;
+  child->next_ = nullptr;
 }
 
+  /* Checks the links of this subtree: every child points back to its parent,
+    prev/next agree with each other and children_/lastChild_ are the ends of
+    the list. Returns false at the first inconsistency. For debugging.
+  */
+  bool checkStructure() const
+  {
+    const Widget* prev = nullptr;
+    for(const Widget* c = children_; c != nullptr; c = c->next_)
+    {
+      if((c->parent_ != this) || (c->prev_ != prev) || !c->checkStructure())
+      {
+        PRINTDEBUG(("checkStructure: bad child %p of %p\n", c, this));
+        return false;
+      }
+      prev = c;
+    }
+    if(lastChild_ != prev)
+    {
+      PRINTDEBUG(("checkStructure: bad lastChild_ of %p\n", this));
+      return false;
+    }
+    return true;
+  }
+
+  // checks the root list and all trees in it
+  static bool checkRoots()
+  {
+    for(const Widget* w = rootWidgets_; w != nullptr; w = w->next_)
+    {
+      if(w->hasParent() || !w->checkStructure())
+      {
+        return false;
+      }
+      // the list must not run into a cycle
+      for(const Widget* v = rootWidgets_; v != w; v = v->next_)
+      {
+        if(v == w->next_)
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
 
   /*****************************************************************************
   * Siblings
@@ -241,15 +332,9 @@ void removeChild(Widget* child)
 
   void moveTo(const Point& p) // (relative to parent)
   {
+    Rectangle old = geometry_;
     geometry_.p0 = p;
-    if(hasParent())
-    {
-      parent()->redraw();
-    }
-    else
-    {
-      redraw();
-    }
+    damageInParent(old | geometry_);
   }
 
   virtual void onResize() {}
@@ -300,20 +385,19 @@ void removeChild(Widget* child)
   *****************************************************************************/
   static const Style& defaultStyle()
   {
-    return defaultStyle_;
+    return StyleTable::style(StyleTable::defaultIndex);
   }
 
   static void setDefaultStyle(const Style& s)
   {
-    defaultStyle_ = s;
+    StyleTable::set(StyleTable::defaultIndex, s);
   }
 
   const Style& style() const
   {
-    if (style_ != nullptr)
+    if (styleIndex_ != StyleTable::inherit)
     {
-//      return defaultStyle();
-      return *style_;
+      return StyleTable::style(styleIndex_);
     }
     else if (hasParent())
     {
@@ -325,9 +409,48 @@ void removeChild(Widget* child)
     }
   }
 
-  void setStyle(const Style& style)
+  StyleIndex styleIndex() const
   {
-    style_ = &style;
+    return styleIndex_;
+  }
+
+  // StyleTable::inherit: use the parent's style
+  void setStyle(StyleIndex i)
+  {
+    if((i != styleIndex_) && (i != StyleTable::invalid))
+    {
+      styleIndex_ = i;
+      redraw();
+    }
+  }
+
+  /* Interns a copy of style. Returns false and keeps the current style if
+    the StyleTable is full.
+  */
+  bool setStyle(const Style& style)
+  {
+    return setInterned(StyleTable::intern(style));
+  }
+
+  bool setStyle(const StyleSpec& spec)
+  {
+    return setInterned(StyleTable::intern(spec));
+  }
+
+  /* Theme switch: changes palette entries and redraws only the widgets whose
+    style resolved to different colors.
+  */
+  static void setPalette(const Color* colors, uint8_t count, PaletteIndex first = 0)
+  {
+    uint32_t changed = StyleTable::setPalette(colors, count, first);
+    if(changed == 0)
+    {
+      return;
+    }
+    for(Widget* w = rootWidgets_; w != nullptr; w = w->next_)
+    {
+      w->restyle(changed, StyleTable::defaultIndex);
+    }
   }
 
   void setFont(const Font font)
@@ -347,7 +470,7 @@ void removeChild(Widget* child)
     }
     else
     {
-      return style().font;
+      return FontRegistry::instance().font(style().font);
     }
   }
 
@@ -383,6 +506,35 @@ void removeChild(Widget* child)
     setTransparent(false);
   }
 
+#if GDISP_NEED_PIXMAP
+  /* A cached widget renders its subtree into an off-screen pixmap (see
+    SubtreeCache) and repaints by blitting it until something inside changes.
+    Meant for opaque parts of a screen that rarely change, like headers.
+  */
+  void setCached(bool b)
+  {
+    if(b == cached())
+    {
+      return;
+    }
+    if(b)
+    {
+      setFlag(flag_cached);
+      redraw();
+    }
+    else
+    {
+      SubtreeCache::instance().release(this);
+      clearFlag(flag_cached);
+    }
+  }
+
+  bool cached() const
+  {
+    return getFlag(flag_cached);
+  }
+#endif // GDISP_NEED_PIXMAP
+
   /*****************************************************************************
   * visibility
   *****************************************************************************/
@@ -391,6 +543,10 @@ void removeChild(Widget* child)
     if(b)
     {
       setFlag(flag_visible);
+      if(needsDrawing())
+      {
+        propagateDirty(); // changes made while hidden weren't propagated
+      }
     }
     else
     {
@@ -426,116 +582,177 @@ void removeChild(Widget* child)
   /*****************************************************************************
   * drawing
   *****************************************************************************/
-  virtual void draw() const
+  virtual void draw(RenderContext& rc) const
   {
     if(opaque())
     {
-      gdispGDrawBox(display(), absX(0), absY(0), width(), height(), colorSet().border);
-      gdispGFillArea(display(), absX(1), absY(1), width()-2, height()-2, colorSet().fill);
+      rc.drawBox(0, 0, width(), height(), colorSet().border);
+      rc.fillArea(1, 1, width()-2, height()-2, colorSet().fill);
     }
     else
     {
       if(!hasParent())
       {
-        gdispGFillArea(display(), absX(1), absY(1), width()-2, height()-2, style().background);
+        rc.fillArea(1, 1, width()-2, height()-2, style().background);
       }
     }
   };
 
   void redraw()
   {
+    TRACELATENCY(damaged(display()));
     setFlag(flag_redraw);
+    invalidateCache();
+    propagateDirty();
     if(transparent() && hasParent())
     {
       parent()->redraw();
     }
   }
 
-
-  static const Coordinate absX(const Coordinate& x)
-  {
-    return x + currentDrawingOffset_.x;
-  }
-  static const Coordinate absX(const Point& p)
+  /* Requests a repaint of the area r (relative to this widget) in the next
+    pass: this widget is drawn clipped to r, and so are the parts of its
+    children that intersect r.
+  */
+  void damage(const Rectangle& r)
   {
-    return absX(p.x);
+    Rectangle d = r & Rectangle(Point(0, 0), size());
+    if(d.empty())
+    {
+      return;
+    }
+    TRACELATENCY(damaged(display()));
+    if(transparent() && hasParent())
+    {
+      parent()->damage(Rectangle(d.p0 + position(), d.size));
+    }
+    damage_ |= d;
+    invalidateCache();
+    propagateDirty();
   }
-  static const Coordinate absY(const Coordinate& y)
+
+  // damages r (relative to the parent) in the parent, or redraws a root
+  void damageInParent(const Rectangle& r)
   {
-    return y + currentDrawingOffset_.y;
+    if(hasParent())
+    {
+      parent()->damage(r);
+    }
+    else
+    {
+      redraw();
+    }
   }
-  static const Coordinate absY(const Point& p)
+
+  /* Requests a partial repaint with drawUpdate() in the next pass, for widgets
+    that can bring their pixels up to date without a full draw(). A pending
+    redraw() takes precedence.
+  */
+  void update()
   {
-    return absY(p.y);
+    TRACELATENCY(damaged(display()));
+    setFlag(flag_update);
+    invalidateCache();
+    propagateDirty();
   }
-  static const Point absPoint(const Point& p)
+
+  // true if this widget or one of its descendants has something to draw
+  bool needsDrawing() const
   {
-    return p + currentDrawingOffset_;
+    return getFlag(flag_redraw | flag_update | flag_dirtyChildren) || !damage_.empty();
   }
-  static const Point absPoint(const Coordinate& x, const Coordinate& y)
+
+  /* Repaints what changed since the last draw() or drawUpdate() and returns
+    true, or returns false to have the widget redrawn completely (which is what
+    the default does). Must not paint over children.
+  */
+  virtual bool drawUpdate(RenderContext& /*rc*/)
   {
-    return absPoint(Point(x,y));
+    return false;
   }
 
 
-  void drawWidget()
+  /* Draws what changed in this subtree. Subtrees without flag_dirtyChildren
+    are skipped, so a pass over an unchanged tree only checks the root. Widgets
+    must not be changed by drawing code.
+  */
+  void drawWidget(RenderContext& rc)
   {
-//    if(moved())
-//    {
-//      flags_ &= ~flag_moved;
-//      geometry_.p0 = newPosition_;
-//    }
-    if(visible())
+    if(visible() && needsDrawing())
     {
-      Point offset_backup = currentDrawingOffset_;
-      currentDrawingOffset_ += position();
-      Rectangle clip_backup = currentClippingRect_;
-      currentClippingRect_ &= Rectangle(absPoint(0,0), size());
-      gdispGSetClip(GDISP,
-                    currentClippingRect_.p0.x,
-                    currentClippingRect_.p0.y,
-                    currentClippingRect_.size.w,
-                    currentClippingRect_.size.h);
-      bool redrawAllChildren = false;
-      if(getFlag(flag_redraw))
+      RenderContext::Scope scope(rc, geometry());
+      if(rc.clipEmpty())
       {
-        redrawAllChildren = true;
-        draw();
+        // completely clipped away, nothing to draw in this subtree
+        clearSubtree();
+        return;
       }
-      Widget* p = children();
-      while(p != nullptr)
+#if GDISP_NEED_PIXMAP
+      if(getFlag(flag_cached) && drawCached(rc))
       {
-        if(redrawAllChildren)
-        {
-          p->redraw();
-        }
-        p->drawWidget();
-        p = p->next();
+        return;
       }
-      clearFlag(flag_redraw);
+#endif // GDISP_NEED_PIXMAP
+      drawContents(rc);
+    }
+  }
 
-      currentDrawingOffset_ = offset_backup;
-      currentClippingRect_ = clip_backup;
-      gdispGSetClip(GDISP,
-                    currentClippingRect_.p0.x,
-                    currentClippingRect_.p0.y,
-                    currentClippingRect_.size.w,
-                    currentClippingRect_.size.h);
+  // returns the summed stats of the passes, all 0 if nothing was drawn
+  static RenderContext::Stats drawWidgets()
+  {
+    // draws the top root of each display in use
+    RenderContext::Stats total = {0, 0};
+    Widget* w = rootWidgets_;
+    while(w != nullptr)
+    {
+      if(topRoot(w->display()) == w)
+      {
+        const RenderContext::Stats s = drawRoot(w);
+        total.clipChanges += s.clipChanges;
+        total.primitives += s.primitives;
+      }
+      w = w->next();
     }
+    return total;
   }
 
-  static void drawWidgets()
+  static RenderContext::Stats drawWidgets(GDisplay* g)
   {
-    // draws only the root that is on top of the list
-    if(rootWidgets_)
+    // draws only the root that is on top of the list for g. Passes for
+    // different displays share no drawing state and may run in different
+    // threads, as long as each tree is only changed by the thread drawing it
+    // and the focus doesn't move (see Focus).
+    Widget* root = topRoot(g);
+    if(root != nullptr)
     {
-      rootWidgets_->drawWidget();
+      return drawRoot(root);
+    }
+    RenderContext::Stats none = {0, 0};
+    return none;
+  }
+
+  /* Like drawWidgets(g), but records the primitives into list instead of
+    drawing them. The list can be optimized and replayed afterwards, and
+    keeps the cached pixmaps it refers to pinned until it is cleared.
+  */
+  static void recordWidgets(GDisplay* g, DrawList& list)
+  {
+    Widget* root = topRoot(g);
+    if(root != nullptr)
+    {
+      RenderContext rc(g, &list);
+      root->drawWidget(rc);
     }
   }
 
   /*****************************************************************************
   * Focus
   *****************************************************************************/
+  /* There is one focus for all displays, as there is one input path
+    (dispatchInputEvent()). Creating a root drops it, whatever display the
+    root is for, and passes read it for the highlighted colors, so it must
+    not move while passes for other displays run in other threads.
+  */
   bool acceptsFocus() const
   {
     return (visible() && getFlag(flag_acceptsFocus));
@@ -562,8 +779,13 @@ void removeChild(Widget* child)
     return (focus() == this);
   }
 
+  // false if nothing took the focus, or while it is locked (see AsyncScreen)
   bool giveFocus()
   {
+    if(focusLocks() != 0)
+    {
+      return false;
+    }
     // first of all:
     if(acceptsFocus() && hasFocus())
     {
@@ -596,6 +818,8 @@ void removeChild(Widget* child)
       getFocusP() = this;
       redraw();
       onFocus();
+      TRACELATENCY(focusChanged());
+      focusChanged()(this);
       PRINTDEBUG(("focused %p\n", focus()));
       return true;
     }
@@ -669,6 +893,13 @@ void removeChild(Widget* child)
     return p_;
   }
 
+  // emitted with the newly focused widget whenever focus moves
+  static Signal<Widget*>& focusChanged()
+  {
+    static Signal<Widget*> s_;
+    return s_;
+  }
+
 
 
   /*****************************************************************************
@@ -676,12 +907,14 @@ void removeChild(Widget* child)
   *****************************************************************************/
   static void dispatchInputEvent(InputEvent& event)
   {
+    TRACELATENCY(beginDispatch(event));
     Widget* w = focus();
     while((w != nullptr) && (!event.accepted()))
     {
       w->onInputEvent(event);
       w = w->parent();
     }
+    TRACELATENCY(endDispatch());
   }
 
   virtual void onInputEvent(InputEvent& event)
@@ -693,13 +926,19 @@ void removeChild(Widget* child)
         case InputEvent::eLeft:
         case InputEvent::eUp:
         case InputEvent::eCCW:
-          focusPrevChild();
+          for(uint16_t i = 0; i < event.count(); i++)
+          {
+            focusPrevChild();
+          }
           event.accept();
           break;
         case InputEvent::eRight:
         case InputEvent::eDown:
         case InputEvent::eCW:
-          focusNextChild();
+          for(uint16_t i = 0; i < event.count(); i++)
+          {
+            focusNextChild();
+          }
           event.accept();
           break;
         case InputEvent::eEnter:
@@ -713,38 +952,53 @@ void removeChild(Widget* child)
   /*****************************************************************************
   * class management
   *****************************************************************************/
+  // identifies the concrete class, e.g. for serializing trees (see screen.h)
+  enum EClass
+  {
+    eClassWidget,
+    eClassLabel,
+    eClassButton,
+    eClassOther
+  };
+
+  virtual uint8_t classId() const
+  {
+    return eClassWidget;
+  }
+
   static void init()
   {
-    defaultStyle_ = {
-      Black,
+    static const Color palette[] = {Black, Gray, White, Orange, Yellow};
+    StyleTable::setPalette(palette, sizeof(palette) / sizeof(palette[0]));
+    StyleSpec spec = {
+      ePaletteBlack,
       { // inactive
-        Black,  // fill
-        Gray, // text
-        Gray  // border
+        ePaletteBlack,  // fill
+        ePaletteGray, // text
+        ePaletteGray  // border
       },
       { // active
-        Gray,  // fill
-        White, // text
-        White  // border
+        ePaletteGray,  // fill
+        ePaletteWhite, // text
+        ePaletteWhite  // border
       },
       { // highlighted
-        Gray,  // fill
-        White, // text
-        Orange  // border
+        ePaletteGray,  // fill
+        ePaletteWhite, // text
+        ePaletteOrange  // border
       },
       { // pressed
-        Yellow,  // fill
-        White, // text
-        White  // border
-      }
+        ePaletteYellow,  // fill
+        ePaletteWhite, // text
+        ePaletteWhite  // border
+      },
+      FontRegistry::defaultId
     };
-    defaultStyle_.font = Style::defaultFont;
-    currentClippingRect_.size = Size(gdispGetWidth(), gdispGetHeight());
+    StyleTable::set(StyleTable::defaultIndex, spec);
   }
 
 
 protected:
-  GDisplay* display() const {return GDISP;}
   const Style::ColorSet& colorSet() const
   {
     if(hasFocus())
@@ -754,30 +1008,216 @@ protected:
 
     return style().active;
   }
-  static Style defaultStyle_;
 private:
-  bool moved() const
+  void drawContents(RenderContext& rc)
   {
-    return (flags_ & flag_moved);
+    bool redrawAllChildren = false;
+    if(getFlag(flag_update) && !getFlag(flag_redraw) && !drawUpdate(rc))
+    {
+      setFlag(flag_redraw);
+    }
+    if(getFlag(flag_redraw))
+    {
+      redrawAllChildren = true;
+      draw(rc);
+    }
+    else if(!damage_.empty())
+    {
+      {
+        RenderContext::ClipScope clip(rc, damage_);
+        draw(rc);
+      }
+      // hand the damaged area down to the children it touches. They are
+      // repainted, not changed, so this doesn't invalidate cached subtrees.
+      Widget* p = children();
+      while(p != nullptr)
+      {
+        p->damage_ |= Rectangle(damage_.p0 - p->position(), damage_.size) &
+                      Rectangle(Point(0, 0), p->size());
+        p = p->next();
+      }
+    }
+    damage_ = Rectangle();
+    // children that still need drawing afterwards are hidden ones, they
+    // propagate again when shown
+    Widget* p = children();
+    while(p != nullptr)
+    {
+      if(redrawAllChildren)
+      {
+        p->setFlag(flag_redraw);
+      }
+      p->drawWidget(rc);
+      p = p->next();
+    }
+    clearFlag(flag_redraw | flag_update | flag_dirtyChildren);
   }
+
+#if GDISP_NEED_PIXMAP
+  /* Brings the pixmap up to date if something inside changed and blits the
+    part that needs repainting. Returns false if the subtree has to be drawn
+    directly.
+  */
+  bool drawCached(RenderContext& rc)
+  {
+    if(transparent())
+    {
+      return false;
+    }
+    // pinned for the pass: nested cached widgets can't evict it while it's
+    // rendered into, and a recorded blit keeps it until the list is cleared
+    SubtreeCache::Entry* e = SubtreeCache::instance().acquire(this, size(), &rc.pins().subtrees);
+    if(e == nullptr)
+    {
+      return false;
+    }
+    Rectangle area = getFlag(flag_redraw) ? Rectangle(Point(0, 0), size()) : damage_;
+    if(!e->valid)
+    {
+      RenderContext cacheContext(e->pixmap);
+      if(e->blank)
+      {
+        setFlag(flag_redraw);
+        e->blank = false;
+      }
+      drawContents(cacheContext);
+      e->valid = true;
+      area |= cacheContext.drawnBounds(); // the pixmap's origin is ours
+    }
+    {
+      RenderContext::ClipScope clip(rc, area);
+      rc.blitArea(0, 0, width(), height(), 0, 0, width(), e->bits());
+    }
+    clearFlag(flag_redraw | flag_update | flag_dirtyChildren);
+    damage_ = Rectangle();
+    return true;
+  }
+#endif // GDISP_NEED_PIXMAP
+
+  void invalidateCache()
+  {
+#if GDISP_NEED_PIXMAP
+    if(getFlag(flag_cached))
+    {
+      SubtreeCache::instance().invalidate(this);
+    }
+#endif // GDISP_NEED_PIXMAP
+  }
+
+  static RenderContext::Stats drawRoot(Widget* root)
+  {
+    if(!root->needsDrawing())
+    {
+      // idle frame, the display isn't touched at all
+      FontRegistry::instance().preloadStep();
+      RenderContext::Stats none = {0, 0};
+      return none;
+    }
+    RenderContext rc(root->display());
+    root->drawWidget(rc);
+    rc.applyClip(); // leave the display unclipped for other drawing code
+    TRACELATENCY(flushed(root->display(), rc.primitives() != 0));
+    if(rc.primitives() == 0)
+    {
+      FontRegistry::instance().preloadStep();
+    }
+    return rc.stats();
+  }
+
+  /* Forgets what needed drawing in this subtree. All of it, or a descendant
+    left with flag_dirtyChildren would stop propagateDirty() below the root.
+  */
+  void clearSubtree()
+  {
+    clearFlag(flag_redraw | flag_update | flag_dirtyChildren);
+    damage_ = Rectangle();
+    for(Widget* p = children(); p != nullptr; p = p->next())
+    {
+      p->clearSubtree();
+    }
+  }
+
+  // while one exists, the focus doesn't move and new roots don't drop it
+  class FocusLock
+  {
+  public:
+    FocusLock()
+    {
+      focusLocks()++;
+    }
+
+    ~FocusLock()
+    {
+      focusLocks()--;
+    }
+  private:
+    FocusLock(const FocusLock&);
+  };
+
+  static uint8_t& focusLocks()
+  {
+    static uint8_t n_ = 0;
+    return n_;
+  }
+
+  // sets flag_dirtyChildren on the ancestors, up to the first that has it
+  void propagateDirty()
+  {
+    for(Widget* w = parent(); (w != nullptr) && !w->getFlag(flag_dirtyChildren); w = w->parent())
+    {
+      w->setFlag(flag_dirtyChildren);
+      w->invalidateCache();
+    }
+  }
+
+  bool setInterned(StyleIndex i)
+  {
+    if(i == StyleTable::invalid)
+    {
+      PRINTDEBUG(("setStyle: style table full, %p keeps its style\n", this));
+      return false;
+    }
+    setStyle(i);
+    return true;
+  }
+
+  // redraws the widgets whose effective style is in the mask
+  void restyle(uint32_t changed, StyleIndex inherited)
+  {
+    StyleIndex i = styleIndex_ != StyleTable::inherit ? styleIndex_ : inherited;
+    if(changed & (1UL << i))
+    {
+      redraw(); // includes the children
+      return;
+    }
+    for(Widget* c = children_; c != nullptr; c = c->next_)
+    {
+      c->restyle(changed, i);
+    }
+  }
+
   Widget* parent_;
   Widget* children_;
   Widget* lastChild_;
   Widget* prev_;
   Widget* next_;
-  const Style* style_;
   Font font_;
+  GDisplay* display_;
   Rectangle geometry_;
+  Rectangle damage_;
   flag_t flags_;
+  StyleIndex styleIndex_;
+  friend class ScreenWriter;
+  friend class AsyncScreen;
   static constexpr flag_t flag_visible      = (1<<0);
+  static constexpr flag_t flag_update       = (1<<1);
   static constexpr flag_t flag_redraw       = (1<<2);
-  static constexpr flag_t flag_moved        = (1<<3);
+  static constexpr flag_t flag_dirtyChildren = (1<<3); // a descendant needs drawing
   static constexpr flag_t flag_acceptsFocus = (1<<4);
   static constexpr flag_t flag_transparent  = (1<<5);
   static constexpr flag_t flag_inactive     = (1<<6);
+  static constexpr flag_t flag_cached       = (1<<7);
   static Widget* rootWidgets_;
-  static Rectangle currentClippingRect_;
-  static Point currentDrawingOffset_;
 };
 } // namespace uwdg
 